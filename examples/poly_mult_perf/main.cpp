@@ -2,6 +2,8 @@
 #include <vector>
 #include <random>
 #include <chrono>
+#include <cstring>
+#include <omp.h>
 
 #include "Polynomial.h" 
 
@@ -9,8 +11,120 @@ using namespace std;
 
 #define MAX_ITER 5000u
 
+/*
+ * Forward + inverse transform time (µs) for each FFT kernel set available
+ * on this CPU: poly_mult_perf kernels
+ */
+void measure_kernels()
+{
+    vector<FFTKernels const *> kernels = { &scalar_fft_kernels() };
+    if (avx2_fft_kernels())
+        kernels.push_back(avx2_fft_kernels());
+    if (avx512_fft_kernels())
+        kernels.push_back(avx512_fft_kernels());
+
+    cout << "points";
+    for (auto k : kernels)
+        cout << "\t" << k->name;
+    cout << endl;
+
+    mt19937 gen(1);
+    uniform_real_distribution<double> dis(-1, 1);
+
+    for (size_t n = 1 << 10; n <= (1 << 22); n <<= 2)
+    {
+        cout << n;
+
+        vector<double> re(n), im(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            re[i] = dis(gen);
+            im[i] = dis(gen);
+        }
+
+        FFTPlan const & plan = FFTPlan::get(n);
+        const size_t repeat = max<size_t>(1, (1 << 24) / n);
+
+        for (auto k : kernels)
+        {
+            auto s = chrono::high_resolution_clock::now();
+
+            for (size_t r = 0; r < repeat; ++r)
+            {
+                plan.forward(re.data(), im.data(), *k);
+                plan.inverse(re.data(), im.data(), *k);
+            }
+
+            auto e = chrono::high_resolution_clock::now();
+
+            cout << "\t" << chrono::duration_cast<chrono::microseconds>(e - s).count() / repeat;
+        }
+        cout << endl;
+    }
+}
+
+/*
+ * FFT multiplication time (µs) against the number of OpenMP threads, for
+ * products above FFTPlan::PARALLEL_THRESHOLD points: poly_mult_perf threads
+ */
+void measure_threads()
+{
+    const vector<size_t> sizes = { 1 << 19, 1 << 20, 1 << 21 };
+
+    cout << "threads";
+    for (auto n : sizes)
+        cout << "\t" << 2 * n;
+    cout << endl;
+
+    mt19937 gen(1);
+    uniform_int_distribution<int> dis(0, 9);
+
+    const int max_threads = omp_get_max_threads();
+
+    for (int threads = 1; threads <= max(max_threads, 8); threads *= 2)
+    {
+        omp_set_num_threads(threads);
+        cout << threads;
+
+        for (auto n : sizes)
+        {
+            vector<double> v(n);
+            for (auto & c : v)
+                c = dis(gen);
+
+            Polynomial<double> p1(v), p2(v);
+
+            // first run builds the plans and grows the workspaces
+            Polynomial<double>(v).FFT_multiplication(p2);
+
+            auto s = chrono::high_resolution_clock::now();
+
+            p1.FFT_multiplication(p2);
+
+            auto e = chrono::high_resolution_clock::now();
+
+            cout << "\t" << chrono::duration_cast<chrono::microseconds>(e - s).count();
+        }
+        cout << endl;
+    }
+
+    omp_set_num_threads(max_threads);
+}
+
 int main(int  argc, char ** argv)
 {
+    if (argc > 1 && strcmp(argv[1], "kernels") == 0)
+    {
+        measure_kernels();
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "threads") == 0)
+    {
+        measure_threads();
+        return 0;
+    }
+
     vector<double> v;
     
     for(auto i=1u; i<=MAX_ITER; i+=50)
@@ -28,7 +142,7 @@ int main(int  argc, char ** argv)
             v.push_back(dis(gen));
         }
 
-        Polynomial<double> p1(v), p2(v), p3(v);
+        Polynomial<double> p1(v), p2(v), p3(v), p4(v);
        
         { 
             auto s = chrono::high_resolution_clock::now();
@@ -40,6 +154,16 @@ int main(int  argc, char ** argv)
             cout << chrono::duration_cast<chrono::microseconds>(e - s).count() << "\t";
         }
 
+        {
+            auto s = chrono::high_resolution_clock::now();
+
+            p4.karatsuba_multiplication(p3);
+
+            auto e = chrono::high_resolution_clock::now();
+
+            cout << chrono::duration_cast<chrono::microseconds>(e - s).count() << "\t";
+        }
+
         { 
             auto s = chrono::high_resolution_clock::now();
             
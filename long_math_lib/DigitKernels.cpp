@@ -0,0 +1,430 @@
+
+#include "DigitKernels.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define LONG_MATH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const uint32_t POW10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+    /*
+     * Scalar loops, also used to finish what the vector loops leave over.
+     * They start at digit i with the given carry (or borrow).
+     */
+    char add_from(const char * a, size_t na, const char * b, size_t nb, char * out, size_t i, char carry)
+    {
+        for (; i < nb; ++i)
+        {
+            const char s = a[i] + b[i] + carry;
+            carry = s > 9;
+            out[i] = carry ? s - 10 : s;
+        }
+
+        // only the carry is left to propagate
+        for (; i < na && carry; ++i)
+        {
+            carry = a[i] == 9;
+            out[i] = carry ? 0 : a[i] + 1;
+        }
+
+        if (out != a && i < na)
+        {
+            std::memcpy(out + i, a + i, na - i);
+        }
+
+        return carry;
+    }
+
+    void sub_from(const char * a, size_t na, const char * b, size_t nb, char * out, size_t i, char borrow)
+    {
+        for (; i < nb; ++i)
+        {
+            const char d = a[i] - b[i] - borrow;
+            borrow = d < 0;
+            out[i] = borrow ? d + 10 : d;
+        }
+
+        for (; i < na && borrow; ++i)
+        {
+            borrow = a[i] == 0;
+            out[i] = borrow ? 9 : a[i] - 1;
+        }
+
+        if (out != a && i < na)
+        {
+            std::memcpy(out + i, a + i, na - i);
+        }
+    }
+
+    // Compares digits [0, n)
+    int8_t compare_from(const char * a, const char * b, size_t n)
+    {
+        while (n-- > 0)
+        {
+            if (a[n] != b[n])
+            {
+                return a[n] < b[n] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    /*
+     * Multiplication by a word works on chunks of 8 digits (values < 10^8),
+     * so the carry chain costs one division by a constant per 8 digits
+     * instead of one per digit
+     */
+    inline uint32_t gather_chunk(const char * d, size_t m)
+    {
+        uint32_t v = 0;
+        for (size_t j = m; j-- > 0; )
+        {
+            v = v * 10 + d[j];
+        }
+        return v;
+    }
+
+    inline void split_chunk(uint32_t v, char * d, size_t m)
+    {
+        for (size_t j = 0; j < m; ++j)
+        {
+            d[j] = v % 10;
+            v /= 10;
+        }
+    }
+
+    uint64_t mul_word_from(char * digits, size_t n, uint32_t factor, size_t i, uint64_t carry)
+    {
+        for (; i + 8 <= n; i += 8)
+        {
+            const uint64_t t = uint64_t(gather_chunk(digits + i, 8)) * factor + carry;
+            carry = t / 100000000;
+            split_chunk(uint32_t(t - carry * 100000000), digits + i, 8);
+        }
+
+        if (i < n)
+        {
+            const size_t m = n - i;
+            const uint64_t t = uint64_t(gather_chunk(digits + i, m)) * factor + carry;
+            carry = t / POW10[m];
+            split_chunk(uint32_t(t - carry * POW10[m]), digits + i, m);
+        }
+
+        return carry;
+    }
+
+    char add_scalar(const char * a, size_t na, const char * b, size_t nb, char * out)
+    {
+        return add_from(a, na, b, nb, out, 0, 0);
+    }
+
+    void sub_scalar(const char * a, size_t na, const char * b, size_t nb, char * out)
+    {
+        sub_from(a, na, b, nb, out, 0, 0);
+    }
+
+    uint64_t mul_word_scalar(char * digits, size_t n, uint32_t factor)
+    {
+        return mul_word_from(digits, n, factor, 0, 0);
+    }
+
+#if defined(LONG_MATH_X86_KERNELS)
+
+    /*
+     * Carry resolution of a whole vector at once. A lane generates a carry when
+     * its digit sum is > 9 and propagates the incoming one when it is 9.
+     * Seen as the bits of two integers x = g | p and y = g, the carries are the
+     * carries of the binary addition x + y + carry_in.
+     */
+    inline uint32_t carries32(uint32_t g, uint32_t p, char & carry)
+    {
+        const uint64_t x = g | p;
+        const uint64_t sum = x + g + carry;
+        carry = (sum >> 32) & 1;
+        return uint32_t(sum ^ x ^ g);
+    }
+
+    inline uint64_t carries64(uint64_t g, uint64_t p, char & carry)
+    {
+        const uint64_t x = g | p;
+        uint64_t sum;
+        const bool c1 = __builtin_add_overflow(x, g, &sum);
+        const bool c2 = __builtin_add_overflow(sum, uint64_t(carry), &sum);
+        carry = c1 || c2;
+        return sum ^ x ^ g;
+    }
+
+    // 32-bit lane mask to a vector of 0/1 bytes
+    __attribute__((target("avx2")))
+    inline __m256i mask_to_ones(uint32_t mask)
+    {
+        const __m256i shuffle = _mm256_setr_epi8( 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1
+                                                , 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+        const __m256i bits = _mm256_set1_epi64x(0x8040201008040201);
+
+        __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(mask), shuffle);
+        v = _mm256_cmpeq_epi8(_mm256_and_si256(v, bits), bits);
+        return _mm256_and_si256(v, _mm256_set1_epi8(1));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i load256(const char * p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+
+    __attribute__((target("avx2")))
+    inline void store256(char * p, __m256i v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+    }
+
+    __attribute__((target("avx2")))
+    char add_avx2(const char * a, size_t na, const char * b, size_t nb, char * out)
+    {
+        const __m256i nine = _mm256_set1_epi8(9);
+        const __m256i ten  = _mm256_set1_epi8(10);
+        char carry = 0;
+        size_t i = 0;
+
+        for (; i + 32 <= nb; i += 32)
+        {
+            __m256i s = _mm256_add_epi8(load256(a + i), load256(b + i));
+
+            const uint32_t g = _mm256_movemask_epi8(_mm256_cmpgt_epi8(s, nine));
+            const uint32_t p = _mm256_movemask_epi8(_mm256_cmpeq_epi8(s, nine));
+
+            s = _mm256_add_epi8(s, mask_to_ones(carries32(g, p, carry)));
+            s = _mm256_sub_epi8(s, _mm256_and_si256(_mm256_cmpgt_epi8(s, nine), ten));
+            store256(out + i, s);
+        }
+
+        return add_from(a, na, b, nb, out, i, carry);
+    }
+
+    __attribute__((target("avx2")))
+    void sub_avx2(const char * a, size_t na, const char * b, size_t nb, char * out)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i ten  = _mm256_set1_epi8(10);
+        char borrow = 0;
+        size_t i = 0;
+
+        for (; i + 32 <= nb; i += 32)
+        {
+            __m256i d = _mm256_sub_epi8(load256(a + i), load256(b + i));
+
+            const uint32_t g = _mm256_movemask_epi8(_mm256_cmpgt_epi8(zero, d));
+            const uint32_t p = _mm256_movemask_epi8(_mm256_cmpeq_epi8(d, zero));
+
+            d = _mm256_sub_epi8(d, mask_to_ones(carries32(g, p, borrow)));
+            d = _mm256_add_epi8(d, _mm256_and_si256(_mm256_cmpgt_epi8(zero, d), ten));
+            store256(out + i, d);
+        }
+
+        sub_from(a, na, b, nb, out, i, borrow);
+    }
+
+    __attribute__((target("avx2")))
+    int8_t compare_avx2(const char * a, const char * b, size_t n)
+    {
+        size_t i = n;
+
+        for (; i >= 32; i -= 32)
+        {
+            const uint32_t eq = _mm256_movemask_epi8(_mm256_cmpeq_epi8(load256(a + i - 32), load256(b + i - 32)));
+
+            if (eq != 0xFFFFFFFF)
+            {
+                const size_t j = i - 32 + (31 - __builtin_clz(~eq));
+                return a[j] < b[j] ? -1 : 1;
+            }
+        }
+
+        return compare_from(a, b, i);
+    }
+
+    // Two digits per 16-bit lane (value < 100) to one digit per byte, tens in the high byte
+    __attribute__((target("avx2")))
+    inline __m256i split_pairs(__m256i y)
+    {
+        const __m256i tens  = _mm256_srli_epi16(_mm256_mullo_epi16(y, _mm256_set1_epi16(103)), 10);
+        const __m256i units = _mm256_sub_epi16(y, _mm256_mullo_epi16(tens, _mm256_set1_epi16(10)));
+        return _mm256_or_si256(units, _mm256_slli_epi16(tens, 8));
+    }
+
+    /*
+     * 64 digits per iteration: gathered into 8 chunks with multiply-adds,
+     * carried through the chunks, split back with reciprocal multiplications
+     */
+    __attribute__((target("avx2")))
+    uint64_t mul_word_avx2(char * digits, size_t n, uint32_t factor)
+    {
+        const __m256i w10     = _mm256_set1_epi16(0x0A01);
+        const __m256i w100    = _mm256_set1_epi32(0x00640001);
+        const __m256i w10000  = _mm256_set1_epi32(0x27100001);
+        const __m256i order   = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+        const __m256i div1e4  = _mm256_set1_epi32(109951163);   // ceil(2^40 / 10^4)
+        const __m256i mul1e4  = _mm256_set1_epi32(10000);
+        const __m256i div100  = _mm256_set1_epi16(5243);        // ceil(2^19 / 100)
+        const __m256i mul100  = _mm256_set1_epi16(100);
+
+        alignas(32) uint32_t chunks[8];
+        uint64_t carry = 0;
+        size_t i = 0;
+
+        for (; i + 64 <= n; i += 64)
+        {
+            // digits -> 4-digit groups -> 8-digit chunks
+            const __m256i lo = _mm256_madd_epi16(_mm256_maddubs_epi16(load256(digits + i),      w10), w100);
+            const __m256i hi = _mm256_madd_epi16(_mm256_maddubs_epi16(load256(digits + i + 32), w10), w100);
+            __m256i c = _mm256_madd_epi16(_mm256_packus_epi32(lo, hi), w10000);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(chunks), _mm256_permutevar8x32_epi32(c, order));
+
+            for (size_t j = 0; j < 8; ++j)
+            {
+                const uint64_t t = uint64_t(chunks[j]) * factor + carry;
+                carry = t / 100000000;
+                chunks[j] = uint32_t(t - carry * 100000000);
+            }
+
+            c = _mm256_load_si256(reinterpret_cast<const __m256i *>(chunks));
+
+            // chunks -> 4-digit groups, low group in the low 16 bits
+            const __m256i q_even = _mm256_srli_epi64(_mm256_mul_epu32(c, div1e4), 40);
+            const __m256i q_odd  = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(c, 32), div1e4), 40);
+            const __m256i q = _mm256_or_si256(q_even, _mm256_slli_epi64(q_odd, 32));
+            const __m256i r = _mm256_sub_epi32(c, _mm256_mullo_epi32(q, mul1e4));
+            const __m256i x = _mm256_or_si256(r, _mm256_slli_epi32(q, 16));
+
+            // 4-digit groups -> 2-digit pairs, back in order across the 128-bit lanes
+            const __m256i h = _mm256_srli_epi16(_mm256_mulhi_epu16(x, div100), 3);
+            const __m256i l = _mm256_sub_epi16(x, _mm256_mullo_epi16(h, mul100));
+            const __m256i pairs_lo = _mm256_unpacklo_epi16(l, h);
+            const __m256i pairs_hi = _mm256_unpackhi_epi16(l, h);
+
+            store256(digits + i,      split_pairs(_mm256_permute2x128_si256(pairs_lo, pairs_hi, 0x20)));
+            store256(digits + i + 32, split_pairs(_mm256_permute2x128_si256(pairs_lo, pairs_hi, 0x31)));
+        }
+
+        return mul_word_from(digits, n, factor, i, carry);
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    char add_avx512(const char * a, size_t na, const char * b, size_t nb, char * out)
+    {
+        const __m512i one  = _mm512_set1_epi8(1);
+        const __m512i nine = _mm512_set1_epi8(9);
+        const __m512i ten  = _mm512_set1_epi8(10);
+        char carry = 0;
+        size_t i = 0;
+
+        for (; i + 64 <= nb; i += 64)
+        {
+            __m512i s = _mm512_add_epi8(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+
+            const uint64_t g = _mm512_cmpgt_epu8_mask(s, nine);
+            const uint64_t p = _mm512_cmpeq_epi8_mask(s, nine);
+
+            s = _mm512_mask_add_epi8(s, carries64(g, p, carry), s, one);
+            s = _mm512_mask_sub_epi8(s, _mm512_cmpgt_epu8_mask(s, nine), s, ten);
+            _mm512_storeu_si512(out + i, s);
+        }
+
+        return add_from(a, na, b, nb, out, i, carry);
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    void sub_avx512(const char * a, size_t na, const char * b, size_t nb, char * out)
+    {
+        const __m512i zero = _mm512_setzero_si512();
+        const __m512i one  = _mm512_set1_epi8(1);
+        const __m512i ten  = _mm512_set1_epi8(10);
+        char borrow = 0;
+        size_t i = 0;
+
+        for (; i + 64 <= nb; i += 64)
+        {
+            __m512i d = _mm512_sub_epi8(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+
+            const uint64_t g = _mm512_cmplt_epi8_mask(d, zero);
+            const uint64_t p = _mm512_cmpeq_epi8_mask(d, zero);
+
+            d = _mm512_mask_sub_epi8(d, carries64(g, p, borrow), d, one);
+            d = _mm512_mask_add_epi8(d, _mm512_cmplt_epi8_mask(d, zero), d, ten);
+            _mm512_storeu_si512(out + i, d);
+        }
+
+        sub_from(a, na, b, nb, out, i, borrow);
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    int8_t compare_avx512(const char * a, const char * b, size_t n)
+    {
+        size_t i = n;
+
+        for (; i >= 64; i -= 64)
+        {
+            const uint64_t eq = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(a + i - 64), _mm512_loadu_si512(b + i - 64));
+
+            if (eq != ~uint64_t(0))
+            {
+                const size_t j = i - 64 + (63 - __builtin_clzll(~eq));
+                return a[j] < b[j] ? -1 : 1;
+            }
+        }
+
+        return compare_from(a, b, i);
+    }
+
+#endif
+
+    DigitKernels const & select_digit_kernels()
+    {
+        if (DigitKernels const * k = avx512_digit_kernels())
+            return *k;
+
+        if (DigitKernels const * k = avx2_digit_kernels())
+            return *k;
+
+        return scalar_digit_kernels();
+    }
+}
+
+DigitKernels const & digit_kernels()
+{
+    static DigitKernels const & kernels = select_digit_kernels();
+    return kernels;
+}
+
+DigitKernels const & scalar_digit_kernels()
+{
+    static const DigitKernels kernels = { "scalar", add_scalar, sub_scalar, compare_from, mul_word_scalar };
+    return kernels;
+}
+
+DigitKernels const * avx2_digit_kernels()
+{
+#if defined(LONG_MATH_X86_KERNELS)
+    static const DigitKernels kernels = { "avx2", add_avx2, sub_avx2, compare_avx2, mul_word_avx2 };
+    return __builtin_cpu_supports("avx2") ? &kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+DigitKernels const * avx512_digit_kernels()
+{
+#if defined(LONG_MATH_X86_KERNELS)
+    // the carry chain dominates multiplication by a word, wider vectors do not help there
+    static const DigitKernels kernels = { "avx512", add_avx512, sub_avx512, compare_avx512, mul_word_avx2 };
+    return (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) ? &kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,51 @@
+#ifndef _DIGIT_KERNELS_H_
+#define _DIGIT_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Kernels working on the magnitude of LongMath values: arrays of decimal
+ * digits (one per byte, least significant first).
+ *
+ * Each instruction set gets its own table, the best one supported by the
+ * running CPU is picked once at startup by digit_kernels().
+ */
+struct DigitKernels
+{
+    const char * name;
+
+    /*
+     * out = a + b, with na >= nb. Writes na digits and returns the carry out.
+     * out may be a.
+     */
+    char (*add)(const char * a, size_t na, const char * b, size_t nb, char * out);
+
+    /*
+     * out = a - b, with a >= b and na >= nb. Writes na digits, out may be a.
+     */
+    void (*sub)(const char * a, size_t na, const char * b, size_t nb, char * out);
+
+    /*
+     * Compares two numbers of n digits, most significant digit first.
+     * Returns -1, 0 or 1.
+     */
+    int8_t (*compare)(const char * a, const char * b, size_t n);
+
+    /*
+     * digits = digits * factor in place, returns what overflows the n digits
+     */
+    uint64_t (*mulWord)(char * digits, size_t n, uint32_t factor);
+};
+
+// Kernels for the running CPU
+DigitKernels const & digit_kernels();
+
+// Portable implementation, always available
+DigitKernels const & scalar_digit_kernels();
+
+// nullptr when the CPU (or the compiler) does not support the instruction set
+DigitKernels const * avx2_digit_kernels();
+DigitKernels const * avx512_digit_kernels();
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef _DOUBLE_DOUBLE_H_
+#define _DOUBLE_DOUBLE_H_
+
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+/*
+ * Floating point number as the unevaluated sum hi + lo of two doubles, with
+ * |lo| at most half an ulp of hi: about 106 bits of significand on double
+ * hardware. Sums use Knuth's two-sum and products the exact low part of
+ * hi * hi' (an fma when available, Dekker's splitting otherwise), so a
+ * result is within a few units of 2^-104 of the exact one.
+ *
+ * Just the arithmetic the transforms need (see ScalarFFT.h), no special
+ * values: infinities and NaN are not handled.
+ */
+class DoubleDouble
+{
+public:
+    constexpr DoubleDouble()
+        : m_hi(0)
+        , m_lo(0)
+    {}
+
+    constexpr DoubleDouble(double v)
+        : m_hi(v)
+        , m_lo(0)
+    {}
+
+    // Exact for every 64-bit integer
+    template<typename Int, typename = typename std::enable_if<std::is_integral<Int>::value>::type>
+    DoubleDouble(Int v)
+        : m_hi(double(v))
+        , m_lo(double(__int128(v) - __int128(m_hi)))
+    {}
+
+    double hi() const { return m_hi; }
+    double lo() const { return m_lo; }
+
+    explicit operator double() const { return m_hi + m_lo; }
+
+    DoubleDouble operator-() const { return DoubleDouble(-m_hi, -m_lo); }
+
+    DoubleDouble operator+(DoubleDouble const & o) const
+    {
+        double e, f;
+        const double s = two_sum(m_hi, o.m_hi, e);
+        const double t = two_sum(m_lo, o.m_lo, f);
+
+        e += t;
+        double r = quick_two_sum(s, e, e);
+        e += f;
+        r = quick_two_sum(r, e, e);
+        return DoubleDouble(r, e);
+    }
+
+    DoubleDouble operator-(DoubleDouble const & o) const { return *this + (-o); }
+
+    DoubleDouble operator*(DoubleDouble const & o) const
+    {
+        double e;
+        const double p = two_prod(m_hi, o.m_hi, e);
+        e += m_hi * o.m_lo + m_lo * o.m_hi;
+
+        const double r = quick_two_sum(p, e, e);
+        return DoubleDouble(r, e);
+    }
+
+    // Long division, three quotient digits
+    DoubleDouble operator/(DoubleDouble const & o) const
+    {
+        const double q1 = m_hi / o.m_hi;
+        DoubleDouble r = *this - o * DoubleDouble(q1);
+        const double q2 = r.m_hi / o.m_hi;
+        r = r - o * DoubleDouble(q2);
+        const double q3 = r.m_hi / o.m_hi;
+
+        double e;
+        const double q = quick_two_sum(q1, q2, e);
+        return DoubleDouble(q, e) + DoubleDouble(q3);
+    }
+
+    DoubleDouble & operator+=(DoubleDouble const & o) { return *this = *this + o; }
+    DoubleDouble & operator-=(DoubleDouble const & o) { return *this = *this - o; }
+    DoubleDouble & operator*=(DoubleDouble const & o) { return *this = *this * o; }
+    DoubleDouble & operator/=(DoubleDouble const & o) { return *this = *this / o; }
+
+    bool operator==(DoubleDouble const & o) const { return m_hi == o.m_hi && m_lo == o.m_lo; }
+    bool operator!=(DoubleDouble const & o) const { return !(*this == o); }
+    bool operator<(DoubleDouble const & o) const  { return m_hi < o.m_hi || (m_hi == o.m_hi && m_lo < o.m_lo); }
+    bool operator>(DoubleDouble const & o) const  { return o < *this; }
+
+    // One Newton step from the double square root
+    friend DoubleDouble sqrt(DoubleDouble const & a)
+    {
+        if (a.m_hi <= 0)
+            return DoubleDouble();
+
+        const double x = std::sqrt(a.m_hi);
+        const DoubleDouble r = a - DoubleDouble(x) * DoubleDouble(x);
+        return DoubleDouble(x) + DoubleDouble(r.m_hi * 0.5 / x);
+    }
+
+    // Nearest integer, exact while it fits in 64 bits
+    friend long long llround(DoubleDouble const & a)
+    {
+        const double r = std::round(a.m_hi);
+        return (long long)r + std::llround((a.m_hi - r) + a.m_lo);
+    }
+
+    friend std::ostream & operator<<(std::ostream & os, DoubleDouble const & a)
+    {
+        return os << double(a);
+    }
+
+private:
+    DoubleDouble(double hi, double lo)
+        : m_hi(hi)
+        , m_lo(lo)
+    {}
+
+    // a + b = s + err exactly
+    static double two_sum(double a, double b, double & err)
+    {
+        const double s  = a + b;
+        const double bb = s - a;
+        err = (a - (s - bb)) + (b - bb);
+        return s;
+    }
+
+    // The same for |a| >= |b|
+    static double quick_two_sum(double a, double b, double & err)
+    {
+        const double s = a + b;
+        err = b - (s - a);
+        return s;
+    }
+
+    // a * b = p + err exactly
+    static double two_prod(double a, double b, double & err)
+    {
+        const double p = a * b;
+#if defined(__FMA__)
+        err = std::fma(a, b, -p);
+#else
+        double a_hi, a_lo, b_hi, b_lo;
+        split(a, a_hi, a_lo);
+        split(b, b_hi, b_lo);
+        err = ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+#endif
+        return p;
+    }
+
+    // a = hi + lo with 26 significant bits each
+    static void split(double a, double & hi, double & lo)
+    {
+        const double t = 134217729.0 * a;   // 2^27 + 1
+        hi = t - (t - a);
+        lo = a - hi;
+    }
+
+private:
+    double m_hi;
+    double m_lo;
+};
+
+#endif
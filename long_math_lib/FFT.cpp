@@ -0,0 +1,809 @@
+
+#include "FFT.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+
+#include <omp.h>
+
+namespace
+{
+    /*
+     * Parallel transforms first run the stages up to this size as independent
+     * sub-transforms (a power of 4, so that passes are grouped as in a serial
+     * transform), then split each remaining pass in slices of butterflies
+     */
+    const size_t PARALLEL_CHUNK = 1 << 14;
+    const size_t PARALLEL_SLICE = 1 << 10;
+
+    /*
+     * Four-step transforms move TILE columns or rows at a time, so that
+     * strided accesses still read and write whole cache lines
+     */
+    const size_t TILE = 32;
+
+    /*
+     * Mixed radix transforms combine the m sub-transforms this many outputs
+     * at a time, so that the m input and output rows of a block stay in L1
+     */
+    const size_t MIXED_BLOCK = 64;
+
+    /*
+     * Odd parts of the supported sizes, with the cost per point of the mixed
+     * radix step in units of a radix-2 stage, measured on 2^12 to 2^19 point
+     * transforms (see FFTPlan::goodSize)
+     */
+    struct OddFactor
+    {
+        size_t odd;
+        double cost;
+    };
+
+    const OddFactor ODD_FACTORS[] =
+    {
+        { 1, 0 }, { 3, 8 }, { 5, 12 }, { 7, 26 }
+    };
+
+    bool supported_odd_factor(size_t odd)
+    {
+        return std::any_of(std::begin(ODD_FACTORS), std::end(ODD_FACTORS),
+                           [odd](OddFactor const & f) { return f.odd == odd; });
+    }
+}
+
+FFTPlan::FFTPlan(size_t n, size_t four_step_threshold)
+    : m_size(n)
+    , m_root_shift(0)
+    , m_columns(nullptr)
+    , m_rows(nullptr)
+    , m_odd(1)
+    , m_pow2(nullptr)
+{
+    size_t odd = n;
+    while (odd != 0 && odd % 2 == 0)
+        odd /= 2;
+
+    if (n == 0 || n > (size_t(1) << 32) || !supported_odd_factor(odd))
+        throw std::invalid_argument("FFT size must be m * 2^k, m being 1, 3, 5 or 7");
+
+    if (odd != 1)
+    {
+        m_odd  = odd;
+        m_pow2 = &FFTPlan::get(n / odd);
+
+        size_t split = 1;
+        while (split * split < n)
+            split <<= 1;
+        buildRoots(split);
+
+        // w^(j2*k1) for the sequences j2 > 0
+        const size_t p = n / odd;
+        m_mixed_twiddles_re.resize((odd - 1) * p);
+        m_mixed_twiddles_im.resize((odd - 1) * p);
+        for (size_t j2 = 1; j2 < odd; ++j2)
+        {
+            for (size_t k1 = 0; k1 < p; ++k1)
+            {
+                const Complex w = rootPower(j2 * k1);
+                m_mixed_twiddles_re[(j2 - 1) * p + k1] = w.real();
+                m_mixed_twiddles_im[(j2 - 1) * p + k1] = w.imag();
+            }
+        }
+
+        m_dft_re.resize(odd * odd);
+        m_dft_im.resize(odd * odd);
+        for (size_t a = 0; a < odd; ++a)
+        {
+            for (size_t b = 0; b < odd; ++b)
+            {
+                const long double theta = 2 * M_PIl * ((a * b) % odd) / odd;
+                m_dft_re[a * odd + b] = std::cos(theta);
+                m_dft_im[a * odd + b] = std::sin(theta);
+            }
+        }
+        return;
+    }
+
+    const uint8_t log_n = static_cast<uint8_t>(std::log2(n));
+
+    if (n >= four_step_threshold && n >= TILE * TILE)
+    {
+        // n = n1 * n2, columns of n1 points, rows of n2 = n1 or 2 * n1 points
+        const size_t n1 = size_t(1) << (log_n / 2);
+        const size_t n2 = n / n1;
+
+        m_columns = &FFTPlan::get(n1);
+        m_rows    = &FFTPlan::get(n2);
+
+        buildRoots(n1);
+
+        // w^(b*k1) for the lanes b of a tile of columns
+        m_lane_re.resize(n1 * TILE);
+        m_lane_im.resize(n1 * TILE);
+        for (size_t k1 = 0; k1 < n1; ++k1)
+        {
+            for (size_t b = 0; b < TILE; ++b)
+            {
+                const long double theta = 2 * M_PIl * (b * k1) / n;
+                m_lane_re[k1 * TILE + b] = std::cos(theta);
+                m_lane_im[k1 * TILE + b] = std::sin(theta);
+            }
+        }
+
+        // twiddles of the column transform, each repeated for the TILE lanes
+        m_tile_twiddles_re.resize(n1 * TILE);
+        m_tile_twiddles_im.resize(n1 * TILE);
+        for (size_t i = 0; i < n1 * TILE; ++i)
+        {
+            m_tile_twiddles_re[i] = m_columns->m_twiddles_re[i / TILE];
+            m_tile_twiddles_im[i] = m_columns->m_twiddles_im[i / TILE];
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t j = (log_n == 0) ? 0 : bit_reverse(i, log_n);
+        if (i < j)
+        {
+            m_swaps.emplace_back(i, j);
+        }
+    }
+
+    m_twiddles_re.resize(n);
+    m_twiddles_im.resize(n);
+    for (size_t h = 1; h < n; h <<= 1)
+    {
+        for (size_t j = 0; j < h; ++j)
+        {
+            const long double theta = M_PIl * j / h;
+            m_twiddles_re[h + j] = std::cos(theta);
+            m_twiddles_im[h + j] = std::sin(theta);
+        }
+    }
+}
+
+void FFTPlan::buildRoots(size_t split)
+{
+    m_root_shift = __builtin_ctzll(split);
+
+    m_root_lo_re.resize(split);
+    m_root_lo_im.resize(split);
+    for (size_t e = 0; e < split; ++e)
+    {
+        const long double theta = 2 * M_PIl * e / m_size;
+        m_root_lo_re[e] = std::cos(theta);
+        m_root_lo_im[e] = std::sin(theta);
+    }
+
+    const size_t hi_size = (m_size + split - 1) / split;
+    m_root_hi_re.resize(hi_size);
+    m_root_hi_im.resize(hi_size);
+    for (size_t e = 0; e < hi_size; ++e)
+    {
+        const long double theta = 2 * M_PIl * (e * split) / m_size;
+        m_root_hi_re[e] = std::cos(theta);
+        m_root_hi_im[e] = std::sin(theta);
+    }
+}
+
+FFTPlan::Complex FFTPlan::rootPower(size_t e) const
+{
+    const size_t lo = e & ((size_t(1) << m_root_shift) - 1);
+    const size_t hi = e >> m_root_shift;
+
+    const double lr = m_root_lo_re[lo], li = m_root_lo_im[lo];
+    const double hr = m_root_hi_re[hi], hi_im = m_root_hi_im[hi];
+    return Complex(lr * hr - li * hi_im, lr * hi_im + li * hr);
+}
+
+FFTPlan::Complex FFTPlan::root(size_t k) const
+{
+    if (!m_root_lo_re.empty())
+    {
+        return rootPower(k);
+    }
+    return Complex(m_twiddles_re[m_size / 2 + k], m_twiddles_im[m_size / 2 + k]);
+}
+
+size_t FFTPlan::goodSize(size_t n)
+{
+    // cost of m * p points: m * p * (log2(p) + cost of the odd factor m)
+    size_t best = 0;
+    double best_cost = 0;
+
+    for (auto const & f : ODD_FACTORS)
+    {
+        size_t pow2 = 2;
+        while (f.odd * pow2 < n)
+            pow2 <<= 1;
+
+        const size_t size = f.odd * pow2;
+        const double cost = size * (std::log2(pow2) + f.cost);
+
+        if (best == 0 || cost < best_cost)
+        {
+            best = size;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+const size_t FFTPlan::PARALLEL_THRESHOLD;
+const size_t FFTPlan::FOUR_STEP_THRESHOLD;
+
+void FFTPlan::passes(double * re, double * im, size_t n, size_t h,
+                     const double * w_re, const double * w_im,
+                     FFTKernels const & kernels, bool inverse) const
+{
+    // two stages per pass while possible, the odd one out is the widest
+    while (h < n)
+    {
+        if (4 * h <= n)
+        {
+            kernels.radix4(re, im, n, h, w_re, w_im, inverse, 0, h);
+            h *= 4;
+        }
+        else
+        {
+            kernels.radix2(re, im, n, h, w_re, w_im, inverse, 0, h);
+            h *= 2;
+        }
+    }
+}
+
+void FFTPlan::transform(double * re, double * im, FFTKernels const & kernels, bool inverse) const
+{
+    if (m_pow2)
+    {
+        mixedRadix(re, im, kernels, inverse);
+        return;
+    }
+
+    if (m_columns)
+    {
+        fourStep(re, im, kernels, inverse);
+        return;
+    }
+
+    const long long n = m_size;
+
+    if (m_size < PARALLEL_THRESHOLD || omp_get_max_threads() == 1)
+    {
+        for (auto const & s : m_swaps)
+        {
+            std::swap(re[s.first], re[s.second]);
+            std::swap(im[s.first], im[s.second]);
+        }
+
+        passes(re, im, m_size, 1, m_twiddles_re.data(), m_twiddles_im.data(), kernels, inverse);
+    }
+    else
+    {
+        const long long swaps = m_swaps.size();
+
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < swaps; ++i)
+        {
+            auto const & s = m_swaps[i];
+            std::swap(re[s.first], re[s.second]);
+            std::swap(im[s.first], im[s.second]);
+        }
+
+        const long long chunks = m_size / PARALLEL_CHUNK;
+        const double * w_re = m_twiddles_re.data();
+        const double * w_im = m_twiddles_im.data();
+
+        #pragma omp parallel for schedule(static)
+        for (long long c = 0; c < chunks; ++c)
+        {
+            passes(re + c * PARALLEL_CHUNK, im + c * PARALLEL_CHUNK, PARALLEL_CHUNK, 1, w_re, w_im, kernels, inverse);
+        }
+
+        for (size_t h = PARALLEL_CHUNK; h < m_size; )
+        {
+            const bool radix4 = 4 * h <= m_size;
+            const long long slices = h / PARALLEL_SLICE;
+
+            #pragma omp parallel for schedule(static)
+            for (long long i = 0; i < slices; ++i)
+            {
+                const size_t begin = i * PARALLEL_SLICE;
+                const size_t end   = begin + PARALLEL_SLICE;
+
+                if (radix4)
+                    kernels.radix4(re, im, m_size, h, w_re, w_im, inverse, begin, end);
+                else
+                    kernels.radix2(re, im, m_size, h, w_re, w_im, inverse, begin, end);
+            }
+
+            h *= radix4 ? 4 : 2;
+        }
+    }
+
+    if (inverse)
+    {
+        const double scale = 1.0 / m_size;
+
+        #pragma omp parallel for schedule(static) if (m_size >= PARALLEL_THRESHOLD)
+        for (long long i = 0; i < n; ++i)
+        {
+            re[i] *= scale;
+            im[i] *= scale;
+        }
+    }
+}
+
+namespace
+{
+    /*
+     * Per-thread buffers of the four-step and mixed radix transforms
+     */
+    enum BufferSlot
+    {
+        SCRATCH_RE, SCRATCH_IM,     // copy of the data, calling thread
+        TILE_RE,    TILE_IM,        // tiles of columns
+        MIXED_RE,   MIXED_IM,       // transforms of n/m points
+        BUFFER_SLOTS
+    };
+
+    double * plan_buffer(BufferSlot slot, size_t n)
+    {
+        thread_local std::vector<double> buffers[BUFFER_SLOTS];
+
+        std::vector<double> & buffer = buffers[slot];
+        if (buffer.size() < n)
+        {
+            buffer.resize(n);
+        }
+        return buffer.data();
+    }
+
+    // dst (cols x rows) = transpose of src (rows x cols), TILE x TILE at a time
+    void transpose(const double * src, double * dst, size_t rows, size_t cols)
+    {
+        const long long row_tiles = rows / TILE;
+
+        #pragma omp parallel for schedule(static) if (rows * cols >= FFTPlan::PARALLEL_THRESHOLD)
+        for (long long t = 0; t < row_tiles; ++t)
+        {
+            const size_t r0 = t * TILE;
+            for (size_t c0 = 0; c0 < cols; c0 += TILE)
+            {
+                for (size_t c = c0; c < c0 + TILE; ++c)
+                    for (size_t r = r0; r < r0 + TILE; ++r)
+                        dst[c * rows + r] = src[r * cols + c];
+            }
+        }
+    }
+}
+
+/*
+ * TILE column transforms at once, on a tile stored row by row (TILE values
+ * per row). Seen as a single array, the butterflies of half size h of the
+ * columns are butterflies of half size h * TILE, so the tile goes through
+ * the usual kernels with each twiddle repeated TILE times.
+ */
+void FFTPlan::tileTransform(double * re, double * im, FFTKernels const & kernels, bool inverse) const
+{
+    for (auto const & s : m_columns->m_swaps)
+    {
+        std::swap_ranges(re + s.first * TILE, re + (s.first + 1) * TILE, re + s.second * TILE);
+        std::swap_ranges(im + s.first * TILE, im + (s.first + 1) * TILE, im + s.second * TILE);
+    }
+
+    passes(re, im, m_columns->size() * TILE, TILE,
+           m_tile_twiddles_re.data(), m_tile_twiddles_im.data(), kernels, inverse);
+}
+
+/*
+ * Bailey's four-step transform, for sizes that do not fit in cache.
+ * With the data as n1 rows of n2 points, j = j1*n2 + j2 and k = k1 + n1*k2:
+ * w^(jk) = w1^(j1*k1) * w^(j2*k1) * w2^(j2*k2), w1 and w2 roots of order n1, n2.
+ *  1. transform the columns (over j1), a tile of TILE columns at a time
+ *     copied to a buffer, and twiddle by w^(j2*k1) on the way back
+ *  2. transform the rows (over j2), in place
+ *  3. transpose, X[k1 + n1*k2] being at k1*n2 + k2, through a scratch copy
+ * Each sub-transform fits in cache, so the data goes through main memory a
+ * few times instead of once per pair of stages.
+ */
+void FFTPlan::fourStep(double * re, double * im, FFTKernels const & kernels, bool inverse) const
+{
+    const size_t n1 = m_columns->size();
+    const size_t n2 = m_rows->size();
+    const double sign  = inverse ? -1.0 : 1.0;
+    const double scale = inverse ? 1.0 / n1 : 1.0;
+
+    const long long column_tiles = n2 / TILE;
+
+    #pragma omp parallel for schedule(static) if (m_size >= PARALLEL_THRESHOLD)
+    for (long long t = 0; t < column_tiles; ++t)
+    {
+        const size_t c0 = t * TILE;
+        double * b_re = plan_buffer(TILE_RE, n1 * TILE);
+        double * b_im = plan_buffer(TILE_IM, n1 * TILE);
+
+        for (size_t j1 = 0; j1 < n1; ++j1)
+        {
+            std::copy(re + j1 * n2 + c0, re + j1 * n2 + c0 + TILE, b_re + j1 * TILE);
+            std::copy(im + j1 * n2 + c0, im + j1 * n2 + c0 + TILE, b_im + j1 * TILE);
+        }
+
+        tileTransform(b_re, b_im, kernels, inverse);
+
+        // w^((c0 + b) * k1) = w^(c0 * k1) * w^(b * k1)
+        for (size_t k1 = 0; k1 < n1; ++k1)
+        {
+            const Complex base = rootPower(c0 * k1) * scale;
+            const double base_re = base.real();
+            const double base_im = base.imag();
+
+            const double * lane_re = m_lane_re.data() + k1 * TILE;
+            const double * lane_im = m_lane_im.data() + k1 * TILE;
+            const double * x_re = b_re + k1 * TILE;
+            const double * x_im = b_im + k1 * TILE;
+            double * out_re = re + k1 * n2 + c0;
+            double * out_im = im + k1 * n2 + c0;
+
+            for (size_t b = 0; b < TILE; ++b)
+            {
+                const double wr = base_re * lane_re[b] - base_im * lane_im[b];
+                const double wi = sign * (base_re * lane_im[b] + base_im * lane_re[b]);
+
+                out_re[b] = wr * x_re[b] - wi * x_im[b];
+                out_im[b] = wr * x_im[b] + wi * x_re[b];
+            }
+        }
+    }
+
+    const long long rows = n1;
+
+    #pragma omp parallel for schedule(static) if (m_size >= PARALLEL_THRESHOLD)
+    for (long long k1 = 0; k1 < rows; ++k1)
+    {
+        if (inverse)
+            m_rows->inverse(re + k1 * n2, im + k1 * n2, kernels);
+        else
+            m_rows->forward(re + k1 * n2, im + k1 * n2, kernels);
+    }
+
+    double * s_re = plan_buffer(SCRATCH_RE, m_size);
+    double * s_im = plan_buffer(SCRATCH_IM, m_size);
+
+    transpose(re, s_re, n1, n2);
+    transpose(im, s_im, n1, n2);
+    std::copy(s_re, s_re + m_size, re);
+    std::copy(s_im, s_im + m_size, im);
+}
+
+/*
+ * Transform of n = m * p points, p a power of 2. With j = j1*m + j2 and
+ * k = k1 + p*k2: w^(jk) = wp^(j1*k1) * w^(j2*k1) * wm^(j2*k2), so
+ *  1. the m interleaved sequences x[j1*m + j2] go through transforms of size p
+ *  2. each output k1 of sequence j2 is twiddled by w^(j2*k1)
+ *  3. DFTs of size m across the sequences give X[k1 + p*k2], the outputs
+ *     k2 forming contiguous rows of p points
+ * Steps 2 and 3 run on blocks of k1, so that all the loops are sequential
+ * over k1 and vectorize.
+ */
+void FFTPlan::mixedRadix(double * re, double * im, FFTKernels const & kernels, bool inverse) const
+{
+    const size_t m = m_odd;
+    const size_t p = m_pow2->size();
+    const size_t block = std::min(p, MIXED_BLOCK);
+    const double sign  = inverse ? -1.0 : 1.0;
+    const double scale = inverse ? 1.0 / m : 1.0;
+
+    double * y_re = plan_buffer(MIXED_RE, m_size);
+    double * y_im = plan_buffer(MIXED_IM, m_size);
+
+    const long long rows = p;
+
+    #pragma omp parallel for schedule(static) if (m_size >= PARALLEL_THRESHOLD)
+    for (long long j1 = 0; j1 < rows; ++j1)
+    {
+        for (size_t j2 = 0; j2 < m; ++j2)
+        {
+            y_re[j2 * p + j1] = re[j1 * m + j2];
+            y_im[j2 * p + j1] = im[j1 * m + j2];
+        }
+    }
+
+    for (size_t j2 = 0; j2 < m; ++j2)
+    {
+        if (inverse)
+            m_pow2->inverse(y_re + j2 * p, y_im + j2 * p, kernels);
+        else
+            m_pow2->forward(y_re + j2 * p, y_im + j2 * p, kernels);
+    }
+
+    const long long blocks = p / block;
+
+    #pragma omp parallel for schedule(static) if (m_size >= PARALLEL_THRESHOLD)
+    for (long long b = 0; b < blocks; ++b)
+    {
+        const size_t k0 = b * block;
+
+        for (size_t j2 = 1; j2 < m; ++j2)
+        {
+            double * __restrict__ yr = y_re + j2 * p + k0;
+            double * __restrict__ yi = y_im + j2 * p + k0;
+            const double * wr = m_mixed_twiddles_re.data() + (j2 - 1) * p + k0;
+            const double * wi = m_mixed_twiddles_im.data() + (j2 - 1) * p + k0;
+
+            for (size_t k = 0; k < block; ++k)
+            {
+                const double tr = yr[k], ti = yi[k], si = sign * wi[k];
+                yr[k] = wr[k] * tr - si * ti;
+                yi[k] = wr[k] * ti + si * tr;
+            }
+        }
+
+        for (size_t k2 = 0; k2 < m; ++k2)
+        {
+            double * __restrict__ xr = re + k2 * p + k0;
+            double * __restrict__ xi = im + k2 * p + k0;
+
+            std::copy(y_re + k0, y_re + k0 + block, xr);
+            std::copy(y_im + k0, y_im + k0 + block, xi);
+
+            for (size_t j2 = 1; j2 < m; ++j2)
+            {
+                const double dr = m_dft_re[k2 * m + j2];
+                const double di = sign * m_dft_im[k2 * m + j2];
+                const double * __restrict__ yr = y_re + j2 * p + k0;
+                const double * __restrict__ yi = y_im + j2 * p + k0;
+
+                for (size_t k = 0; k < block; ++k)
+                {
+                    xr[k] += dr * yr[k] - di * yi[k];
+                    xi[k] += dr * yi[k] + di * yr[k];
+                }
+            }
+
+            if (inverse)
+            {
+                for (size_t k = 0; k < block; ++k)
+                {
+                    xr[k] *= scale;
+                    xi[k] *= scale;
+                }
+            }
+        }
+    }
+}
+
+void FFTPlan::forward(double * re, double * im, FFTKernels const & kernels) const
+{
+    transform(re, im, kernels, false);
+}
+
+void FFTPlan::inverse(double * re, double * im, FFTKernels const & kernels) const
+{
+    transform(re, im, kernels, true);
+}
+
+void FFTPlan::convolveReal(double * re, double * im) const
+{
+    const size_t n = m_size;
+    const size_t h = n / 2;
+
+    if (n == 1)
+    {
+        re[0] *= im[0];
+        im[0] = 0;
+        return;
+    }
+
+    forward(re, im);
+
+    // With Z the transform of a + i*b, A[k] = (Z[k] + conj(Z[-k])) / 2 and
+    // B[k] = (Z[k] - conj(Z[-k])) / 2i, so C[k] = (Z[k]^2 - conj(Z[-k])^2) / 4i
+    auto product = [&] (size_t k)
+    {
+        const size_t  nk = (k == 0) ? 0 : n - k;
+        const Complex z (re[k],   im[k]);
+        const Complex zc(re[nk], -im[nk]);
+        const Complex d  = z * z - zc * zc;
+        return Complex(d.imag(), -d.real()) * 0.25;
+    };
+
+    // Transform of c[2m] + i*c[2m+1] (half size) is E[k] + i*O[k] with
+    // E[k] = (C[k] + C[k+h]) / 2 and O[k] = (C[k] - C[k+h]) * w^-k / 2
+    auto fold = [&] (size_t k, Complex const & c_k, Complex const & c_kh)
+    {
+        const Complex e = (c_k + c_kh) * 0.5;
+        const Complex o = (c_k - c_kh) * std::conj(root(k)) * 0.5;
+        return Complex(e.real() - o.imag(), e.imag() + o.real());
+    };
+
+    // k, h-k, k+h and n-k only depend on each other, update them together
+    const long long groups = h / 2 + 1;
+
+    #pragma omp parallel for schedule(static) if (n >= PARALLEL_THRESHOLD)
+    for (long long i = 0; i < groups; ++i)
+    {
+        const size_t k  = i;
+        const size_t k2 = h - k;
+
+        const Complex c_k   = product(k);
+        const Complex c_kh  = product(k + h);
+
+        if (k != 0 && k2 != k)
+        {
+            const Complex c_k2  = product(k2);
+            const Complex c_k2h = product(k2 + h);
+            const Complex y = fold(k2, c_k2, c_k2h);
+            re[k2] = y.real();
+            im[k2] = y.imag();
+        }
+        const Complex y = fold(k, c_k, c_kh);
+        re[k] = y.real();
+        im[k] = y.imag();
+    }
+
+    FFTPlan::get(h).inverse(re, im);
+}
+
+void FFTPlan::forwardReal(double * re, double * im) const
+{
+    const size_t h = m_size / 2;
+
+    FFTPlan::get(h).forward(re, im);
+
+    // With Z the half size transform, E[k] = (Z[k] + conj(Z[h-k])) / 2 and
+    // O[k] = (Z[k] - conj(Z[h-k])) / 2i are the transforms of the even and
+    // odd points, X[k] = E[k] + w^k O[k] and X[h-k] = conj(E[k] - w^k O[k])
+    const double e0 = re[0];
+    const double o0 = im[0];
+    re[0] = e0 + o0;
+    im[0] = e0 - o0;
+
+    const long long groups = h / 2 + 1;
+
+    #pragma omp parallel for schedule(static) if (m_size >= PARALLEL_THRESHOLD)
+    for (long long i = 1; i < groups; ++i)
+    {
+        const size_t k  = i;
+        const size_t k2 = h - k;
+
+        const Complex z (re[k],   im[k]);
+        const Complex zc(re[k2], -im[k2]);
+        const Complex e = (z + zc) * 0.5;
+        const Complex d = (z - zc) * 0.5;
+        const Complex o = root(k) * Complex(d.imag(), -d.real());
+
+        const Complex x  = e + o;
+        const Complex x2 = std::conj(e - o);
+
+        re[k]  = x.real();
+        im[k]  = x.imag();
+        re[k2] = x2.real();
+        im[k2] = x2.imag();
+    }
+}
+
+void FFTPlan::inverseReal(double * re, double * im) const
+{
+    const size_t h = m_size / 2;
+
+    // Back to Z[k] = E[k] + i*O[k], with E[k] = (X[k] + X[k+h]) / 2 and
+    // O[k] = (X[k] - X[k+h]) * w^-k / 2, X[k+h] = conj(X[h-k])
+    const double x0 = re[0];
+    const double xh = im[0];
+    re[0] = (x0 + xh) * 0.5;
+    im[0] = (x0 - xh) * 0.5;
+
+    const long long groups = h / 2 + 1;
+
+    #pragma omp parallel for schedule(static) if (m_size >= PARALLEL_THRESHOLD)
+    for (long long i = 1; i < groups; ++i)
+    {
+        const size_t k  = i;
+        const size_t k2 = h - k;
+
+        const Complex x (re[k],  im[k]);
+        const Complex x2(re[k2], im[k2]);
+
+        const Complex e = (x + std::conj(x2)) * 0.5;
+        const Complex o = (x - std::conj(x2)) * std::conj(root(k)) * 0.5;
+        const Complex z = Complex(e.real() - o.imag(), e.imag() + o.real());
+
+        // the same for h - k, where X[k2+h] = conj(X[k])
+        const Complex e2 = (x2 + std::conj(x)) * 0.5;
+        const Complex o2 = (x2 - std::conj(x)) * std::conj(root(k2)) * 0.5;
+        const Complex z2 = Complex(e2.real() - o2.imag(), e2.imag() + o2.real());
+
+        re[k]  = z.real();
+        im[k]  = z.imag();
+        re[k2] = z2.real();
+        im[k2] = z2.imag();
+    }
+
+    FFTPlan::get(h).inverse(re, im);
+}
+
+void FFTPlan::multiplyReal(double * re, double * im, const double * b_re, const double * b_im) const
+{
+    const size_t h = m_size / 2;
+
+    // X[0] and X[n/2] are real
+    const double x0 = re[0] * b_re[0];
+    const double xh = im[0] * b_im[0];
+
+    #pragma omp parallel for schedule(static) if (m_size >= PARALLEL_THRESHOLD)
+    for (long long i = 0; i < (long long)h; ++i)
+    {
+        const double r = re[i] * b_re[i] - im[i] * b_im[i];
+        const double m = re[i] * b_im[i] + im[i] * b_re[i];
+        re[i] = r;
+        im[i] = m;
+    }
+
+    re[0] = x0;
+    im[0] = xh;
+}
+
+void FFTPlan::multiplyAddReal(double * re, double * im, const double * a_re, const double * a_im,
+                              const double * b_re, const double * b_im) const
+{
+    const size_t h = m_size / 2;
+
+    // X[0] and X[n/2] are real
+    const double x0 = re[0] + a_re[0] * b_re[0];
+    const double xh = im[0] + a_im[0] * b_im[0];
+
+    #pragma omp parallel for schedule(static) if (m_size >= PARALLEL_THRESHOLD)
+    for (long long i = 0; i < (long long)h; ++i)
+    {
+        re[i] += a_re[i] * b_re[i] - a_im[i] * b_im[i];
+        im[i] += a_re[i] * b_im[i] + a_im[i] * b_re[i];
+    }
+
+    re[0] = x0;
+    im[0] = xh;
+}
+
+FFTPlan const & FFTPlan::get(size_t n)
+{
+    // plans are never released, there is at most one per power of 2
+    static std::mutex mutex;
+    static std::map<size_t, std::unique_ptr<FFTPlan>> plans;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = plans.find(n);
+        if (it != plans.end())
+            return *it->second;
+    }
+
+    // built unlocked, large plans get the plans of their rows and columns from here
+    std::unique_ptr<FFTPlan> built(new FFTPlan(n));
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto & plan = plans[n];
+    if (!plan)
+    {
+        plan = std::move(built);
+    }
+    return *plan;
+}
+
+double * fft_workspace(size_t slot, size_t n)
+{
+    thread_local std::vector<double> buffers[FFT_WORKSPACE_SLOTS];
+
+    std::vector<double> & buffer = buffers[slot];
+    if (buffer.size() < n)
+    {
+        buffer.resize(n);
+    }
+    return buffer.data();
+}
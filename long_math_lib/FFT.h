@@ -0,0 +1,184 @@
+#ifndef _FFT_H_
+#define _FFT_H_
+
+#include <complex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "FFTKernels.h"
+
+static const unsigned char BitReverseTable256[] =
+{
+  0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
+  0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
+  0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
+  0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC,
+  0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2, 0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2,
+  0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
+  0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6,
+  0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE, 0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
+  0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
+  0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9,
+  0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5, 0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
+  0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
+  0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3,
+  0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB, 0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
+  0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
+  0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF
+};
+
+inline uint32_t bit_reverse(uint32_t i, uint8_t n)
+{
+    uint32_t c =    (BitReverseTable256[ i        & 0xff] << 24) |
+                    (BitReverseTable256[(i >> 8)  & 0xff] << 16) |
+                    (BitReverseTable256[(i >> 16) & 0xff] << 8 ) |
+                    (BitReverseTable256[(i >> 24) & 0xff]);
+
+    c >>= 32 - n;
+    return c;
+}
+
+/*
+ * Everything a radix-2 transform of size n (a power of 2) needs, computed once:
+ * the bit reversal permutation as a list of swaps, and the twiddle factors of
+ * every stage, each one evaluated directly instead of by repeated
+ * multiplication. Transforms run in place and a plan is immutable once built,
+ * so the same plan can be used by several threads at once.
+ *
+ * Data is in split layout, real parts in re[] and imaginary parts in im[], so
+ * that the butterflies (see FFTKernels) work on full vectors of each.
+ * From four_step_threshold points on, a transform is split into transforms
+ * of about sqrt(n) points that fit in cache (see fourStep).
+ *
+ * Sizes m * 2^k with an odd part m of 3, 5 or 7 are supported too, on top of
+ * the 2^k transform (see mixedRadix). goodSize() picks the cheapest size for
+ * a given length, so that large products are not always padded to the next
+ * power of 2.
+ *
+ * The forward transform uses the e^(+2*pi*i/n) root, the inverse one
+ * includes the 1/n scaling.
+ */
+class FFTPlan
+{
+public:
+    using Complex = std::complex<double>;
+
+    // From this size on, transforms are shared by the OpenMP threads
+    static const size_t PARALLEL_THRESHOLD = 1 << 20;
+
+    // From this size on, transforms use the four-step decomposition
+    static const size_t FOUR_STEP_THRESHOLD = 1 << 22;
+
+    explicit FFTPlan(size_t n, size_t four_step_threshold = FOUR_STEP_THRESHOLD);
+
+    /*
+     * Size at least n (and at least 2) with the cheapest transform, among
+     * the even sizes that convolveReal needs
+     */
+    static size_t goodSize(size_t n);
+
+    size_t size() const { return m_size; }
+
+    void forward(double * re, double * im, FFTKernels const & kernels = fft_kernels()) const;
+    void inverse(double * re, double * im, FFTKernels const & kernels = fft_kernels()) const;
+
+    /*
+     * Cyclic convolution of two real sequences a and b, packed as
+     * re[j] = a[j], im[j] = b[j]. Hermitian symmetry gives both spectra from
+     * one transform, and since the product is real it comes back from a
+     * transform of half the size: on return re[m] = c[2m] and im[m] = c[2m+1]
+     * for m < n/2 (re[0] = c[0] when n is 1).
+     */
+    void convolveReal(double * re, double * im) const;
+
+    /*
+     * Transform X of a real sequence x of n points (n even) by one transform
+     * of n/2 points, with x packed as re[m] = x[2m], im[m] = x[2m+1]. X is
+     * Hermitian, so its first half is enough: on return re[k] + i*im[k] = X[k]
+     * for 0 < k < n/2, re[0] = X[0] and im[0] = X[n/2] (both real).
+     */
+    void forwardReal(double * re, double * im) const;
+
+    // Inverse of forwardReal, with the 1/n scaling
+    void inverseReal(double * re, double * im) const;
+
+    // Pointwise product of two spectra from forwardReal, into re and im
+    void multiplyReal(double * re, double * im, const double * b_re, const double * b_im) const;
+
+    // Adds the pointwise product of the spectra a and b to re and im
+    void multiplyAddReal(double * re, double * im, const double * a_re, const double * a_im,
+                         const double * b_re, const double * b_im) const;
+
+    // Plan for size n shared by all threads, built on first use
+    static FFTPlan const & get(size_t n);
+
+private:
+    void transform(double * re, double * im, FFTKernels const & kernels, bool inverse) const;
+
+    // Stages with butterflies of half size h and up, over n contiguous points
+    void passes(double * re, double * im, size_t n, size_t h,
+                const double * w_re, const double * w_im,
+                FFTKernels const & kernels, bool inverse) const;
+
+    // Transforms of size FOUR_STEP_THRESHOLD and up
+    void fourStep(double * re, double * im, FFTKernels const & kernels, bool inverse) const;
+    void tileTransform(double * re, double * im, FFTKernels const & kernels, bool inverse) const;
+
+    // Sizes with an odd factor
+    void mixedRadix(double * re, double * im, FFTKernels const & kernels, bool inverse) const;
+
+    // Fills the m_root tables, splitting exponents at a power of 2
+    void buildRoots(size_t split);
+
+    // w^e = e^(2*pi*i*e/n) for e < n, from the m_root tables
+    Complex rootPower(size_t e) const;
+
+    // e^(2*pi*i*k/n) for k < n/2
+    Complex root(size_t k) const;
+
+private:
+    size_t                                     m_size;
+    std::vector<std::pair<uint32_t, uint32_t>> m_swaps;
+    // stage with butterflies of half size h uses [h, 2h)
+    std::vector<double>                        m_twiddles_re;
+    std::vector<double>                        m_twiddles_im;
+
+    // four-step and mixed radix transforms: powers of the root w^e split as
+    // w^(e mod 2^shift) (lo) times w^(2^shift * (e >> shift)) (hi)
+    unsigned                                   m_root_shift;
+    std::vector<double>                        m_root_lo_re;
+    std::vector<double>                        m_root_lo_im;
+    std::vector<double>                        m_root_hi_re;
+    std::vector<double>                        m_root_hi_im;
+
+    // four-step transforms: plans of the columns (n1 points) and rows
+    FFTPlan const *                            m_columns;
+    FFTPlan const *                            m_rows;
+    // w^(b*k1) for each lane b of a tile of columns, and the twiddles of the
+    // column transform repeated for each lane
+    std::vector<double>                        m_lane_re;
+    std::vector<double>                        m_lane_im;
+    std::vector<double>                        m_tile_twiddles_re;
+    std::vector<double>                        m_tile_twiddles_im;
+
+    // mixed radix transforms: odd factor m, plan of the n/m points transforms,
+    // the m x m roots of the DFT of size m, and w^(j2*k1) for j2 in [1, m)
+    size_t                                     m_odd;
+    FFTPlan const *                            m_pow2;
+    std::vector<double>                        m_dft_re;
+    std::vector<double>                        m_dft_im;
+    std::vector<double>                        m_mixed_twiddles_re;
+    std::vector<double>                        m_mixed_twiddles_im;
+};
+
+/*
+ * Per-thread scratch buffers for transforms, grown on demand and kept for the
+ * next call, so that steady-state multiplications do not allocate.
+ * Returns a buffer of at least n elements.
+ */
+static const size_t FFT_WORKSPACE_SLOTS = 2;
+
+double * fft_workspace(size_t slot, size_t n);
+
+#endif
@@ -0,0 +1,370 @@
+#include "FFTKernels.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define LONG_MATH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    /*
+     * Scalar passes, also used by the vector kernels for the first stages,
+     * where butterflies are narrower than a vector
+     */
+    template<bool Inverse>
+    void radix2_pass(double * re, double * im, size_t n, size_t h,
+                     const double * w_re, const double * w_im,
+                     size_t begin, size_t end)
+    {
+        const double s = Inverse ? -1.0 : 1.0;
+        w_re += h;
+        w_im += h;
+
+        for (size_t k = 0; k < n; k += 2 * h)
+        {
+            double * ar = re + k, * ai = im + k;
+            double * br = ar + h, * bi = ai + h;
+
+            for (size_t j = begin; j < end; ++j)
+            {
+                const double wr = w_re[j], wi = s * w_im[j];
+                const double tr = wr * br[j] - wi * bi[j];
+                const double ti = wr * bi[j] + wi * br[j];
+                const double ur = ar[j], ui = ai[j];
+
+                ar[j] = ur + tr;  ai[j] = ui + ti;
+                br[j] = ur - tr;  bi[j] = ui - ti;
+            }
+        }
+    }
+
+    /*
+     * Within a block of 4h points, x0..x3 at offsets j, j+h, j+2h, j+3h:
+     * the first stage pairs (x0, x1) and (x2, x3) with twiddle w[h+j], the
+     * second one (x0, x2) with w[2h+j] and (x1, x3) with w[3h+j], which is
+     * w[2h+j] times i (-i for the inverse).
+     */
+    template<bool Inverse>
+    void radix4_pass(double * re, double * im, size_t n, size_t h,
+                     const double * w_re, const double * w_im,
+                     size_t begin, size_t end)
+    {
+        const double s = Inverse ? -1.0 : 1.0;
+        const double * w1r = w_re + h,     * w1i = w_im + h;
+        const double * w2r = w_re + 2 * h, * w2i = w_im + 2 * h;
+
+        for (size_t k = 0; k < n; k += 4 * h)
+        {
+            double * r0 = re + k, * r1 = r0 + h, * r2 = r1 + h, * r3 = r2 + h;
+            double * i0 = im + k, * i1 = i0 + h, * i2 = i1 + h, * i3 = i2 + h;
+
+            for (size_t j = begin; j < end; ++j)
+            {
+                const double ar = w1r[j], ai = s * w1i[j];
+                const double br = w2r[j], bi = s * w2i[j];
+
+                const double t1r = ar * r1[j] - ai * i1[j], t1i = ar * i1[j] + ai * r1[j];
+                const double t3r = ar * r3[j] - ai * i3[j], t3i = ar * i3[j] + ai * r3[j];
+
+                const double a0r = r0[j] + t1r, a0i = i0[j] + t1i;
+                const double a1r = r0[j] - t1r, a1i = i0[j] - t1i;
+                const double a2r = r2[j] + t3r, a2i = i2[j] + t3i;
+                const double a3r = r2[j] - t3r, a3i = i2[j] - t3i;
+
+                const double ur = br * a2r - bi * a2i, ui = br * a2i + bi * a2r;
+                const double pr = br * a3r - bi * a3i, pi = br * a3i + bi * a3r;
+                const double vr = -s * pi, vi = s * pr;
+
+                r0[j] = a0r + ur;  i0[j] = a0i + ui;
+                r2[j] = a0r - ur;  i2[j] = a0i - ui;
+                r1[j] = a1r + vr;  i1[j] = a1i + vi;
+                r3[j] = a1r - vr;  i3[j] = a1i - vi;
+            }
+        }
+    }
+
+    void radix2_scalar(double * re, double * im, size_t n, size_t h,
+                       const double * w_re, const double * w_im, bool inverse,
+                       size_t begin, size_t end)
+    {
+        if (inverse)
+            radix2_pass<true>(re, im, n, h, w_re, w_im, begin, end);
+        else
+            radix2_pass<false>(re, im, n, h, w_re, w_im, begin, end);
+    }
+
+    void radix4_scalar(double * re, double * im, size_t n, size_t h,
+                       const double * w_re, const double * w_im, bool inverse,
+                       size_t begin, size_t end)
+    {
+        if (inverse)
+            radix4_pass<true>(re, im, n, h, w_re, w_im, begin, end);
+        else
+            radix4_pass<false>(re, im, n, h, w_re, w_im, begin, end);
+    }
+
+#if defined(LONG_MATH_X86_KERNELS)
+
+    /*
+     * AVX2 + FMA, 4 butterflies at a time. Conjugation and the multiplication
+     * by +-i are sign flips: xor with -0.0.
+     */
+    __attribute__((target("avx2,fma")))
+    inline void cmul256(__m256d wr, __m256d wi, __m256d xr, __m256d xi, __m256d & r, __m256d & i)
+    {
+        r = _mm256_fmsub_pd(wr, xr, _mm256_mul_pd(wi, xi));
+        i = _mm256_fmadd_pd(wr, xi, _mm256_mul_pd(wi, xr));
+    }
+
+    __attribute__((target("avx2,fma")))
+    void radix2_avx2(double * re, double * im, size_t n, size_t h,
+                     const double * w_re, const double * w_im, bool inverse,
+                     size_t begin, size_t end)
+    {
+        if (h < 4)
+            return radix2_scalar(re, im, n, h, w_re, w_im, inverse, begin, end);
+
+        const __m256d conj = _mm256_set1_pd(inverse ? -0.0 : 0.0);
+        w_re += h;
+        w_im += h;
+
+        for (size_t k = 0; k < n; k += 2 * h)
+        {
+            double * ar = re + k, * ai = im + k;
+            double * br = ar + h, * bi = ai + h;
+
+            for (size_t j = begin; j < end; j += 4)
+            {
+                const __m256d wr = _mm256_loadu_pd(w_re + j);
+                const __m256d wi = _mm256_xor_pd(_mm256_loadu_pd(w_im + j), conj);
+
+                __m256d tr, ti;
+                cmul256(wr, wi, _mm256_loadu_pd(br + j), _mm256_loadu_pd(bi + j), tr, ti);
+
+                const __m256d ur = _mm256_loadu_pd(ar + j), ui = _mm256_loadu_pd(ai + j);
+
+                _mm256_storeu_pd(ar + j, _mm256_add_pd(ur, tr));
+                _mm256_storeu_pd(ai + j, _mm256_add_pd(ui, ti));
+                _mm256_storeu_pd(br + j, _mm256_sub_pd(ur, tr));
+                _mm256_storeu_pd(bi + j, _mm256_sub_pd(ui, ti));
+            }
+        }
+    }
+
+    __attribute__((target("avx2,fma")))
+    void radix4_avx2(double * re, double * im, size_t n, size_t h,
+                     const double * w_re, const double * w_im, bool inverse,
+                     size_t begin, size_t end)
+    {
+        if (h < 4)
+            return radix4_scalar(re, im, n, h, w_re, w_im, inverse, begin, end);
+
+        // forward: v = i*p = (-p_im, p_re), inverse: v = -i*p = (p_im, -p_re)
+        const __m256d conj  = _mm256_set1_pd(inverse ? -0.0 : 0.0);
+        const __m256d rot_r = _mm256_set1_pd(inverse ? 0.0 : -0.0);
+        const __m256d rot_i = _mm256_set1_pd(inverse ? -0.0 : 0.0);
+
+        const double * w1r = w_re + h,     * w1i = w_im + h;
+        const double * w2r = w_re + 2 * h, * w2i = w_im + 2 * h;
+
+        for (size_t k = 0; k < n; k += 4 * h)
+        {
+            double * r0 = re + k, * r1 = r0 + h, * r2 = r1 + h, * r3 = r2 + h;
+            double * i0 = im + k, * i1 = i0 + h, * i2 = i1 + h, * i3 = i2 + h;
+
+            for (size_t j = begin; j < end; j += 4)
+            {
+                const __m256d ar = _mm256_loadu_pd(w1r + j);
+                const __m256d ai = _mm256_xor_pd(_mm256_loadu_pd(w1i + j), conj);
+                const __m256d br = _mm256_loadu_pd(w2r + j);
+                const __m256d bi = _mm256_xor_pd(_mm256_loadu_pd(w2i + j), conj);
+
+                const __m256d x0r = _mm256_loadu_pd(r0 + j), x0i = _mm256_loadu_pd(i0 + j);
+                const __m256d x2r = _mm256_loadu_pd(r2 + j), x2i = _mm256_loadu_pd(i2 + j);
+
+                __m256d t1r, t1i, t3r, t3i;
+                cmul256(ar, ai, _mm256_loadu_pd(r1 + j), _mm256_loadu_pd(i1 + j), t1r, t1i);
+                cmul256(ar, ai, _mm256_loadu_pd(r3 + j), _mm256_loadu_pd(i3 + j), t3r, t3i);
+
+                const __m256d a0r = _mm256_add_pd(x0r, t1r), a0i = _mm256_add_pd(x0i, t1i);
+                const __m256d a1r = _mm256_sub_pd(x0r, t1r), a1i = _mm256_sub_pd(x0i, t1i);
+                const __m256d a2r = _mm256_add_pd(x2r, t3r), a2i = _mm256_add_pd(x2i, t3i);
+                const __m256d a3r = _mm256_sub_pd(x2r, t3r), a3i = _mm256_sub_pd(x2i, t3i);
+
+                __m256d ur, ui, pr, pi;
+                cmul256(br, bi, a2r, a2i, ur, ui);
+                cmul256(br, bi, a3r, a3i, pr, pi);
+
+                const __m256d vr = _mm256_xor_pd(pi, rot_r);
+                const __m256d vi = _mm256_xor_pd(pr, rot_i);
+
+                _mm256_storeu_pd(r0 + j, _mm256_add_pd(a0r, ur));
+                _mm256_storeu_pd(i0 + j, _mm256_add_pd(a0i, ui));
+                _mm256_storeu_pd(r2 + j, _mm256_sub_pd(a0r, ur));
+                _mm256_storeu_pd(i2 + j, _mm256_sub_pd(a0i, ui));
+                _mm256_storeu_pd(r1 + j, _mm256_add_pd(a1r, vr));
+                _mm256_storeu_pd(i1 + j, _mm256_add_pd(a1i, vi));
+                _mm256_storeu_pd(r3 + j, _mm256_sub_pd(a1r, vr));
+                _mm256_storeu_pd(i3 + j, _mm256_sub_pd(a1i, vi));
+            }
+        }
+    }
+
+    /*
+     * AVX-512, 8 butterflies at a time, narrower passes go to AVX2
+     */
+    __attribute__((target("avx512f")))
+    inline void cmul512(__m512d wr, __m512d wi, __m512d xr, __m512d xi, __m512d & r, __m512d & i)
+    {
+        r = _mm512_fmsub_pd(wr, xr, _mm512_mul_pd(wi, xi));
+        i = _mm512_fmadd_pd(wr, xi, _mm512_mul_pd(wi, xr));
+    }
+
+    // xor is an AVX512DQ instruction for doubles, go through integers
+    __attribute__((target("avx512f")))
+    inline __m512d flip512(__m512d v, __m512i mask)
+    {
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(v), mask));
+    }
+
+    __attribute__((target("avx512f")))
+    void radix2_avx512(double * re, double * im, size_t n, size_t h,
+                       const double * w_re, const double * w_im, bool inverse,
+                       size_t begin, size_t end)
+    {
+        if (h < 8)
+            return radix2_avx2(re, im, n, h, w_re, w_im, inverse, begin, end);
+
+        const __m512i conj = _mm512_set1_epi64(inverse ? INT64_MIN : 0);
+        w_re += h;
+        w_im += h;
+
+        for (size_t k = 0; k < n; k += 2 * h)
+        {
+            double * ar = re + k, * ai = im + k;
+            double * br = ar + h, * bi = ai + h;
+
+            for (size_t j = begin; j < end; j += 8)
+            {
+                const __m512d wr = _mm512_loadu_pd(w_re + j);
+                const __m512d wi = flip512(_mm512_loadu_pd(w_im + j), conj);
+
+                __m512d tr, ti;
+                cmul512(wr, wi, _mm512_loadu_pd(br + j), _mm512_loadu_pd(bi + j), tr, ti);
+
+                const __m512d ur = _mm512_loadu_pd(ar + j), ui = _mm512_loadu_pd(ai + j);
+
+                _mm512_storeu_pd(ar + j, _mm512_add_pd(ur, tr));
+                _mm512_storeu_pd(ai + j, _mm512_add_pd(ui, ti));
+                _mm512_storeu_pd(br + j, _mm512_sub_pd(ur, tr));
+                _mm512_storeu_pd(bi + j, _mm512_sub_pd(ui, ti));
+            }
+        }
+    }
+
+    __attribute__((target("avx512f")))
+    void radix4_avx512(double * re, double * im, size_t n, size_t h,
+                       const double * w_re, const double * w_im, bool inverse,
+                       size_t begin, size_t end)
+    {
+        if (h < 8)
+            return radix4_avx2(re, im, n, h, w_re, w_im, inverse, begin, end);
+
+        const __m512i conj  = _mm512_set1_epi64(inverse ? INT64_MIN : 0);
+        // forward: v = i*p = (-p_im, p_re), inverse: v = -i*p = (p_im, -p_re)
+        const __m512i rot_r = _mm512_set1_epi64(inverse ? 0 : INT64_MIN);
+        const __m512i rot_i = _mm512_set1_epi64(inverse ? INT64_MIN : 0);
+
+        const double * w1r = w_re + h,     * w1i = w_im + h;
+        const double * w2r = w_re + 2 * h, * w2i = w_im + 2 * h;
+
+        for (size_t k = 0; k < n; k += 4 * h)
+        {
+            double * r0 = re + k, * r1 = r0 + h, * r2 = r1 + h, * r3 = r2 + h;
+            double * i0 = im + k, * i1 = i0 + h, * i2 = i1 + h, * i3 = i2 + h;
+
+            for (size_t j = begin; j < end; j += 8)
+            {
+                const __m512d ar = _mm512_loadu_pd(w1r + j);
+                const __m512d ai = flip512(_mm512_loadu_pd(w1i + j), conj);
+                const __m512d br = _mm512_loadu_pd(w2r + j);
+                const __m512d bi = flip512(_mm512_loadu_pd(w2i + j), conj);
+
+                const __m512d x0r = _mm512_loadu_pd(r0 + j), x0i = _mm512_loadu_pd(i0 + j);
+                const __m512d x2r = _mm512_loadu_pd(r2 + j), x2i = _mm512_loadu_pd(i2 + j);
+
+                __m512d t1r, t1i, t3r, t3i;
+                cmul512(ar, ai, _mm512_loadu_pd(r1 + j), _mm512_loadu_pd(i1 + j), t1r, t1i);
+                cmul512(ar, ai, _mm512_loadu_pd(r3 + j), _mm512_loadu_pd(i3 + j), t3r, t3i);
+
+                const __m512d a0r = _mm512_add_pd(x0r, t1r), a0i = _mm512_add_pd(x0i, t1i);
+                const __m512d a1r = _mm512_sub_pd(x0r, t1r), a1i = _mm512_sub_pd(x0i, t1i);
+                const __m512d a2r = _mm512_add_pd(x2r, t3r), a2i = _mm512_add_pd(x2i, t3i);
+                const __m512d a3r = _mm512_sub_pd(x2r, t3r), a3i = _mm512_sub_pd(x2i, t3i);
+
+                __m512d ur, ui, pr, pi;
+                cmul512(br, bi, a2r, a2i, ur, ui);
+                cmul512(br, bi, a3r, a3i, pr, pi);
+
+                const __m512d vr = flip512(pi, rot_r);
+                const __m512d vi = flip512(pr, rot_i);
+
+                _mm512_storeu_pd(r0 + j, _mm512_add_pd(a0r, ur));
+                _mm512_storeu_pd(i0 + j, _mm512_add_pd(a0i, ui));
+                _mm512_storeu_pd(r2 + j, _mm512_sub_pd(a0r, ur));
+                _mm512_storeu_pd(i2 + j, _mm512_sub_pd(a0i, ui));
+                _mm512_storeu_pd(r1 + j, _mm512_add_pd(a1r, vr));
+                _mm512_storeu_pd(i1 + j, _mm512_add_pd(a1i, vi));
+                _mm512_storeu_pd(r3 + j, _mm512_sub_pd(a1r, vr));
+                _mm512_storeu_pd(i3 + j, _mm512_sub_pd(a1i, vi));
+            }
+        }
+    }
+
+#endif
+
+    FFTKernels const & select_fft_kernels()
+    {
+        if (FFTKernels const * k = avx512_fft_kernels())
+            return *k;
+
+        if (FFTKernels const * k = avx2_fft_kernels())
+            return *k;
+
+        return scalar_fft_kernels();
+    }
+}
+
+FFTKernels const & fft_kernels()
+{
+    static FFTKernels const & kernels = select_fft_kernels();
+    return kernels;
+}
+
+FFTKernels const & scalar_fft_kernels()
+{
+    static const FFTKernels kernels = { "scalar", radix2_scalar, radix4_scalar };
+    return kernels;
+}
+
+FFTKernels const * avx2_fft_kernels()
+{
+#if defined(LONG_MATH_X86_KERNELS)
+    static const FFTKernels kernels = { "avx2", radix2_avx2, radix4_avx2 };
+    return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ? &kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+FFTKernels const * avx512_fft_kernels()
+{
+#if defined(LONG_MATH_X86_KERNELS)
+    static const FFTKernels kernels = { "avx512", radix2_avx512, radix4_avx512 };
+    return (__builtin_cpu_supports("avx512f") && avx2_fft_kernels()) ? &kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,50 @@
+#ifndef _FFT_KERNELS_H_
+#define _FFT_KERNELS_H_
+
+#include <cstddef>
+
+/*
+ * Butterfly passes of the radix-2 decimation in time FFT (bit reversed input)
+ * on a split layout: real parts in re[], imaginary parts in im[].
+ *
+ * w_re/w_im is the twiddle table of FFTPlan, the pass with butterflies of
+ * half size h uses w[h, 2h). The inverse passes use conjugate twiddles.
+ *
+ * Only the butterflies at offsets [begin, end) of each block are computed
+ * ([0, h) for the whole pass), so that threads can share a pass. Bounds
+ * of a partial range are multiples of 8.
+ *
+ * Each instruction set gets its own table, the best one supported by the
+ * running CPU is picked once at startup by fft_kernels().
+ */
+struct FFTKernels
+{
+    const char * name;
+
+    /*
+     * Pass with butterflies of half size h over n points
+     */
+    void (*radix2)(double * re, double * im, size_t n, size_t h,
+                   const double * w_re, const double * w_im, bool inverse,
+                   size_t begin, size_t end);
+
+    /*
+     * Passes of half sizes h and 2h fused (4h <= n), so that the data is
+     * read and written once for two stages
+     */
+    void (*radix4)(double * re, double * im, size_t n, size_t h,
+                   const double * w_re, const double * w_im, bool inverse,
+                   size_t begin, size_t end);
+};
+
+// Kernels for the running CPU
+FFTKernels const & fft_kernels();
+
+// Portable implementation, always available
+FFTKernels const & scalar_fft_kernels();
+
+// nullptr when the CPU (or the compiler) does not support the instruction set
+FFTKernels const * avx2_fft_kernels();
+FFTKernels const * avx512_fft_kernels();
+
+#endif
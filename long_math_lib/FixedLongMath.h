@@ -0,0 +1,320 @@
+#ifndef _FIXED_LONG_MATH_H_
+#define _FIXED_LONG_MATH_H_
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include "LongMath.h"
+
+/*
+ * Unsigned integer of a fixed width of Bits bits stored in a std::array of
+ * 32-bit limbs, least significant limb first.
+ * Arithmetic wraps modulo 2^Bits exactly as the built-in unsigned types do.
+ * Every loop has a compile-time trip count, so the compiler unrolls them and
+ * no operation ever touches the heap.
+ */
+template<size_t Bits>
+class FixedLongMath
+{
+    static_assert(Bits > 0 && Bits % 32 == 0, "FixedLongMath width must be a multiple of 32 bits");
+
+public:
+    using Limb       = uint32_t;
+    using DoubleLimb = uint64_t;
+
+    static constexpr size_t LIMB_BITS = 32;
+    static constexpr size_t LIMBS     = Bits / LIMB_BITS;
+
+    using LimbArray = std::array<Limb, LIMBS>;
+
+    constexpr FixedLongMath()
+        : limbs{}
+    {}
+
+    constexpr FixedLongMath(uint64_t val)
+        : limbs{}
+    {
+        limbs[0] = static_cast<Limb>(val);
+        if (LIMBS > 1)
+        {
+            limbs[1] = static_cast<Limb>(val >> LIMB_BITS);
+        }
+    }
+
+    constexpr FixedLongMath(LimbArray const & l)
+        : limbs(l)
+    {}
+
+    /*
+     * Conversion from LongMath. Negative values are stored in two's complement
+     * and values wider than Bits are truncated, as for a cast to an unsigned type.
+     */
+    explicit FixedLongMath(LongMath const & lm)
+        : limbs{}
+    {
+        // 9 decimal digits at a time, most significant first
+        static const Limb powers10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+        LongMath::Buffer const & digits = lm.getValue();
+        size_t i = digits.size();
+
+        while (i > 0)
+        {
+            const size_t chunk = (i % 9 == 0) ? 9 : i % 9;
+            Limb word = 0;
+
+            for (size_t j = 0; j < chunk; ++j)
+            {
+                word = word * 10 + digits[--i];
+            }
+
+            mulAddWord(powers10[chunk], word);
+        }
+
+        if (lm.isNegative())
+        {
+            *this = FixedLongMath() - *this;
+        }
+    }
+
+    /*
+     * Widening conversion to LongMath, it never loses information
+     */
+    operator LongMath() const
+    {
+        return toLongMath();
+    }
+
+    LongMath toLongMath() const
+    {
+        LongMath::Buffer digits;
+        digits.reserve(Bits * 30103 / 100000 + 1);
+
+        FixedLongMath tmp(*this);
+        while (!tmp.isZero())
+        {
+            Limb rem = tmp.divModWord(1000000000);
+
+            for (size_t j = 0; j < 9; ++j)
+            {
+                digits.push_back(rem % 10);
+                rem /= 10;
+            }
+        }
+
+        while (!digits.empty() && digits.back() == 0)
+        {
+            digits.pop_back();
+        }
+
+        return LongMath(digits);
+    }
+
+    constexpr Limb   operator[](size_t index) const { return limbs[index]; }
+    constexpr Limb & operator[](size_t index)       { return limbs[index]; }
+
+    constexpr LimbArray const & getLimbs() const { return limbs; }
+
+    constexpr bool isZero() const
+    {
+        Limb acc = 0;
+        for (size_t i = 0; i < LIMBS; ++i)
+        {
+            acc |= limbs[i];
+        }
+        return acc == 0;
+    }
+
+    constexpr int8_t compare(const FixedLongMath & f) const
+    {
+        for (size_t i = LIMBS; i-- > 0; )
+        {
+            if (limbs[i] != f.limbs[i])
+            {
+                return limbs[i] < f.limbs[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    constexpr bool operator== (const FixedLongMath & f) const { return compare(f) == 0; }
+    constexpr bool operator!= (const FixedLongMath & f) const { return compare(f) != 0; }
+    constexpr bool operator<  (const FixedLongMath & f) const { return compare(f) <  0; }
+    constexpr bool operator>  (const FixedLongMath & f) const { return compare(f) >  0; }
+    constexpr bool operator<= (const FixedLongMath & f) const { return compare(f) <= 0; }
+    constexpr bool operator>= (const FixedLongMath & f) const { return compare(f) >= 0; }
+
+    constexpr FixedLongMath & operator+= (const FixedLongMath & f)
+    {
+        DoubleLimb carry = 0;
+        for (size_t i = 0; i < LIMBS; ++i)
+        {
+            const DoubleLimb sum = DoubleLimb(limbs[i]) + f.limbs[i] + carry;
+            limbs[i] = static_cast<Limb>(sum);
+            carry = sum >> LIMB_BITS;
+        }
+        return *this;
+    }
+
+    constexpr FixedLongMath & operator-= (const FixedLongMath & f)
+    {
+        Limb borrow = 0;
+        for (size_t i = 0; i < LIMBS; ++i)
+        {
+            const DoubleLimb diff = DoubleLimb(limbs[i]) - f.limbs[i] - borrow;
+            limbs[i] = static_cast<Limb>(diff);
+            borrow = (diff >> LIMB_BITS) ? 1 : 0;
+        }
+        return *this;
+    }
+
+    /*
+     * Schoolbook multiplication truncated to the low LIMBS limbs
+     */
+    constexpr FixedLongMath & operator*= (const FixedLongMath & f)
+    {
+        LimbArray res{};
+        for (size_t i = 0; i < LIMBS; ++i)
+        {
+            DoubleLimb carry = 0;
+            for (size_t j = 0; j + i < LIMBS; ++j)
+            {
+                const DoubleLimb prod = DoubleLimb(limbs[i]) * f.limbs[j] + res[i + j] + carry;
+                res[i + j] = static_cast<Limb>(prod);
+                carry = prod >> LIMB_BITS;
+            }
+        }
+        limbs = res;
+        return *this;
+    }
+
+    constexpr FixedLongMath operator+ (const FixedLongMath & f) const { FixedLongMath tmp(*this); tmp += f; return tmp; }
+    constexpr FixedLongMath operator- (const FixedLongMath & f) const { FixedLongMath tmp(*this); tmp -= f; return tmp; }
+    constexpr FixedLongMath operator* (const FixedLongMath & f) const { FixedLongMath tmp(*this); tmp *= f; return tmp; }
+
+    /*
+     * this = this * factor + addend, returns the limb shifted out on overflow
+     */
+    constexpr Limb mulAddWord(Limb factor, Limb addend)
+    {
+        DoubleLimb carry = addend;
+        for (size_t i = 0; i < LIMBS; ++i)
+        {
+            const DoubleLimb prod = DoubleLimb(limbs[i]) * factor + carry;
+            limbs[i] = static_cast<Limb>(prod);
+            carry = prod >> LIMB_BITS;
+        }
+        return static_cast<Limb>(carry);
+    }
+
+    /*
+     * this = this / divisor, returns the remainder
+     */
+    constexpr Limb divModWord(Limb divisor)
+    {
+        if (divisor == 0)
+            throw std::domain_error("Division by zero");
+
+        DoubleLimb rem = 0;
+        for (size_t i = LIMBS; i-- > 0; )
+        {
+            const DoubleLimb cur = (rem << LIMB_BITS) | limbs[i];
+            limbs[i] = static_cast<Limb>(cur / divisor);
+            rem = cur % divisor;
+        }
+        return static_cast<Limb>(rem);
+    }
+
+    /*
+     * Parses digits with the prefixes of C++ integer literals: 0x or 0X for
+     * hexadecimal, 0b or 0B for binary, a leading 0 for octal, decimal
+     * otherwise; ' is accepted as a separator. Throws on invalid digits or if the value does not fit in Bits bits, which
+     * turns into a compilation error when evaluated in a constant expression.
+     */
+    static constexpr FixedLongMath parse(const char * str, size_t len)
+    {
+        FixedLongMath res;
+        Limb base = 10;
+        size_t i = 0;
+
+        if (len > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+        {
+            base = 16;
+            i = 2;
+        }
+        else if (len > 2 && str[0] == '0' && (str[1] == 'b' || str[1] == 'B'))
+        {
+            base = 2;
+            i = 2;
+        }
+        else if (len > 1 && str[0] == '0')
+        {
+            base = 8;
+            i = 1;
+        }
+
+        for (; i < len; ++i)
+        {
+            const char c = str[i];
+            Limb digit = 0;
+
+            if (c == '\'')
+                continue;
+            else if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (base == 16 && c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (base == 16 && c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+            else
+                throw std::invalid_argument("Not a digit");
+
+            if (digit >= base)
+                throw std::invalid_argument("Not a digit");
+
+            if (res.mulAddWord(base, digit) != 0)
+                throw std::out_of_range("Literal does not fit in FixedLongMath");
+        }
+
+        return res;
+    }
+
+private:
+    LimbArray limbs;
+};
+
+template<size_t Bits>
+std::ostream & operator<<(std::ostream & os, FixedLongMath<Bits> const & f)
+{
+    return os << f.toLongMath();
+}
+
+using FixedLongMath256  = FixedLongMath<256>;
+using FixedLongMath512  = FixedLongMath<512>;
+using FixedLongMath1024 = FixedLongMath<1024>;
+using FixedLongMath2048 = FixedLongMath<2048>;
+using FixedLongMath4096 = FixedLongMath<4096>;
+
+/*
+ * User-defined literals building FixedLongMath constants at compile time:
+ *     constexpr auto p = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF_flm256;
+ */
+namespace fixed_long_math_literals
+{
+    template<size_t Bits, char... Digits>
+    constexpr FixedLongMath<Bits> make_fixed_literal()
+    {
+        constexpr char str[] = { Digits... };
+        return FixedLongMath<Bits>::parse(str, sizeof...(Digits));
+    }
+
+    template<char... Digits> constexpr FixedLongMath<256>  operator"" _flm256()  { return make_fixed_literal<256,  Digits...>(); }
+    template<char... Digits> constexpr FixedLongMath<512>  operator"" _flm512()  { return make_fixed_literal<512,  Digits...>(); }
+    template<char... Digits> constexpr FixedLongMath<1024> operator"" _flm1024() { return make_fixed_literal<1024, Digits...>(); }
+    template<char... Digits> constexpr FixedLongMath<2048> operator"" _flm2048() { return make_fixed_literal<2048, Digits...>(); }
+    template<char... Digits> constexpr FixedLongMath<4096> operator"" _flm4096() { return make_fixed_literal<4096, Digits...>(); }
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef _KRONECKER_H_
+#define _KRONECKER_H_
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#include "LongMath.h"
+
+/*
+ * Kronecker substitution: the product of two polynomials with integer
+ * coeficients is read off the product of the integers a(X) * b(X), X = 10^d,
+ * once d is wide enough for every coeficient of the result. One LongMath
+ * multiplication (FFT tier for large operands) replaces the n^2 coeficient
+ * products.
+ *
+ * Coeficients may be negative: they are packed as they are (a(X) is then
+ * computed as a difference), and unpacked as balanced digits in
+ * (-X/2, X/2) with a carry.
+ *
+ * Coeficients are integral types or LongMath. Integral results are computed
+ * modulo 2^128, so they are exact whenever they fit in the coeficient type.
+ */
+namespace kronecker
+{
+    using Buffer = LongMath::Buffer;
+
+    inline bool is_negative(LongMath const & c) { return c.isNegative(); }
+
+    template<typename Int>
+    bool is_negative(Int c) { return c < 0; }
+
+    // Decimal digits of |c|, least significant first, appended to out
+    inline void abs_digits(LongMath const & c, Buffer & out)
+    {
+        out.insert(out.end(), c.getValue().begin(), c.getValue().end());
+    }
+
+    template<typename Int>
+    void abs_digits(Int c, Buffer & out)
+    {
+        unsigned __int128 v = is_negative(c) ? 0 - (unsigned __int128)c : (unsigned __int128)c;
+        for (; v != 0; v /= 10)
+            out.push_back(char(v % 10));
+    }
+
+    template<typename Coef>
+    size_t max_digits(std::vector<Coef> const & coefs)
+    {
+        Buffer digits;
+        size_t m = 0;
+        for (auto const & c : coefs)
+        {
+            digits.clear();
+            abs_digits(c, digits);
+            m = std::max(m, digits.size());
+        }
+        return m;
+    }
+
+    inline size_t decimal_digits(size_t v)
+    {
+        size_t d = 1;
+        for (; v >= 10; v /= 10)
+            ++d;
+        return d;
+    }
+
+    /*
+     * Block width d: |coeficients of a * b| < 10^(da + db) * min(|a|, |b|),
+     * one more digit keeps them below X/2 for balanced unpacking
+     */
+    template<typename Coef>
+    size_t block_digits(std::vector<Coef> const & a, std::vector<Coef> const & b)
+    {
+        return max_digits(a) + max_digits(b) + decimal_digits(std::min(a.size(), b.size())) + 1;
+    }
+
+    // The integer sum of coefs[i] * 10^(d*i)
+    template<typename Coef>
+    LongMath pack(std::vector<Coef> const & coefs, size_t d)
+    {
+        Buffer positive(coefs.size() * d, 0);
+        Buffer negative;
+        Buffer digits;
+
+        for (size_t i = 0; i < coefs.size(); ++i)
+        {
+            digits.clear();
+            abs_digits(coefs[i], digits);
+
+            Buffer & out = is_negative(coefs[i]) ? negative : positive;
+            if (out.size() < coefs.size() * d)
+                out.resize(coefs.size() * d, 0);
+
+            std::copy(digits.begin(), digits.end(), out.begin() + i * d);
+        }
+
+        if (negative.empty())
+            return LongMath(std::move(positive));
+
+        return LongMath(std::move(positive)) - LongMath(std::move(negative));
+    }
+
+    /*
+     * Balanced value of the block of digits at first, with the carry of the
+     * lower block: block + carry - X when that is at least X/2, setting the
+     * carry for the next block
+     */
+    template<typename Coef>
+    Coef block_value(const char * first, size_t d, bool & carry)
+    {
+        // block + carry >= 5 * 10^(d-1)
+        const bool all_nines = std::all_of(first, first + d - 1, [] (char c) { return c == 9; });
+        const bool wraps = first[d - 1] >= 5 || (carry && first[d - 1] == 4 && all_nines);
+
+        if constexpr (std::is_same<Coef, LongMath>::value)
+        {
+            LongMath v = LongMath(Buffer(first, first + d)) + LongMath(carry ? 1 : 0);
+            if (wraps)
+            {
+                Buffer x(d + 1, 0);
+                x[d] = 1;
+                v = v - LongMath(std::move(x));
+            }
+            carry = wraps;
+            return v;
+        }
+        else
+        {
+            // modulo 2^128
+            unsigned __int128 v = 0, x = 1;
+            for (size_t i = d; i-- > 0; )
+            {
+                v = v * 10 + first[i];
+                x = x * 10;
+            }
+            v += carry ? 1 : 0;
+            if (wraps)
+                v -= x;
+            carry = wraps;
+            return static_cast<Coef>(v);
+        }
+    }
+
+    // Inverse of pack for count coeficients in (-X/2, X/2)
+    template<typename Coef>
+    std::vector<Coef> unpack(LongMath const & v, size_t d, size_t count)
+    {
+        Buffer digits(v.getValue());
+        digits.resize(std::max(digits.size(), count * d), 0);
+
+        std::vector<Coef> coefs;
+        coefs.reserve(count);
+
+        bool carry = false;
+        for (size_t i = 0; i < count; ++i)
+        {
+            Coef c = block_value<Coef>(digits.data() + i * d, d, carry);
+
+            if (v.isNegative())
+            {
+                if constexpr (std::is_same<Coef, LongMath>::value)
+                    c.opposite();
+                else
+                    c = Coef(0) - c;
+            }
+            coefs.push_back(std::move(c));
+        }
+        return coefs;
+    }
+}
+
+/*
+ * a * b by Kronecker substitution, a.size() + b.size() - 1 coeficients
+ */
+template<typename Coef>
+std::vector<Coef> kronecker_product(std::vector<Coef> const & a, std::vector<Coef> const & b)
+{
+    if (a.empty() || b.empty())
+        return {};
+
+    const size_t d = kronecker::block_digits(a, b);
+    const LongMath product = kronecker::pack(a, d) * kronecker::pack(b, d);
+
+    return kronecker::unpack<Coef>(product, d, a.size() + b.size() - 1);
+}
+
+#endif
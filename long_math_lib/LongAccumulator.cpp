@@ -0,0 +1,208 @@
+
+#include "LongAccumulator.h"
+#include "Polynomial.h"
+
+#include <cstdlib>
+
+const int64_t LongAccumulator::LIMB_MAX;
+const size_t  LongAccumulator::SCHOOLBOOK_LIMIT;
+
+namespace
+{
+    // Division rounding towards minus infinity, so that remainders are digits
+    inline int64_t floor_div10(int64_t v)
+    {
+        const int64_t q = v / 10;
+        return (v % 10 < 0) ? q - 1 : q;
+    }
+}
+
+LongAccumulator::LongAccumulator()
+    : m_bound(0)
+{}
+
+LongAccumulator::LongAccumulator(LongMath const & initial)
+    : m_bound(0)
+{
+    *this += initial;
+}
+
+void LongAccumulator::clear()
+{
+    m_limbs.clear();
+    m_bound = 0;
+}
+
+void LongAccumulator::reserveHeadroom(int64_t increase)
+{
+    if (m_bound + increase > LIMB_MAX)
+    {
+        normalize();
+    }
+}
+
+void LongAccumulator::add(LongMath::View const & v, bool negate)
+{
+    if (v.size == 0)
+        return;
+
+    reserveHeadroom(9);
+
+    if (m_limbs.size() < v.size)
+    {
+        m_limbs.resize(v.size, 0);
+    }
+
+    Limb * limbs = m_limbs.data();
+
+    // no carries, so these loops vectorize
+    if (v.isNegative() != negate)
+    {
+        for (size_t i = 0; i < v.size; ++i)
+            limbs[i] -= v.digits[i];
+    }
+    else
+    {
+        for (size_t i = 0; i < v.size; ++i)
+            limbs[i] += v.digits[i];
+    }
+
+    m_bound += 9;
+}
+
+void LongAccumulator::addProduct(LongMath const & a, LongMath const & b)
+{
+    LongMath::Buffer const & x = a.getValue();
+    LongMath::Buffer const & y = b.getValue();
+
+    const size_t shorter = std::min(x.size(), y.size());
+    if (shorter == 0)
+        return;
+
+    // a limb receives at most one product of digits per digit of the shorter factor
+    const int64_t increase = 81 * int64_t(shorter);
+
+    const Limb sign = (a.isNegative() != b.isNegative()) ? -1 : 1;
+
+    if (shorter > SCHOOLBOOK_LIMIT || increase + 9 > LIMB_MAX)
+    {
+        addConvolution(x, y, sign);
+        return;
+    }
+
+    reserveHeadroom(increase);
+
+    if (m_limbs.size() < x.size() + y.size())
+    {
+        m_limbs.resize(x.size() + y.size(), 0);
+    }
+
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+        const Limb xi = sign * x[i];
+        Limb * limbs = m_limbs.data() + i;
+
+        for (size_t j = 0; j < y.size(); ++j)
+        {
+            limbs[j] += xi * y[j];
+        }
+    }
+
+    m_bound += increase;
+}
+
+void LongAccumulator::addConvolution(LongMath::Buffer const & x, LongMath::Buffer const & y, Limb sign)
+{
+    // exact digit convolution, by Karatsuba or a transform depending on the sizes
+    Polynomial<int64_t> product, factor;
+    product.assign(x);
+    factor.assign(y);
+    product *= factor;
+
+    reserveHeadroom(9);
+
+    // the product has at most x.size() + y.size() digits, the carry included
+    if (m_limbs.size() < x.size() + y.size())
+    {
+        m_limbs.resize(x.size() + y.size(), 0);
+    }
+
+    Limb * limbs = m_limbs.data();
+
+    int64_t carry = 0;
+    size_t i = 0;
+    for (; i < product.size(); ++i)
+    {
+        const int64_t v = product[i] + carry;
+        carry = v / 10;
+        limbs[i] += sign * Limb(v - 10 * carry);
+    }
+    for (; carry > 0; ++i, carry /= 10)
+    {
+        limbs[i] += sign * Limb(carry % 10);
+    }
+
+    m_bound += 9;
+}
+
+void LongAccumulator::normalize()
+{
+    int64_t carry = 0;
+
+    for (auto & limb : m_limbs)
+    {
+        const int64_t v = limb + carry;
+        carry = floor_div10(v);
+        limb = Limb(v - 10 * carry);
+    }
+
+    // all limbs are digits now, a negative total keeps a negative top limb
+    for (; carry > 0; carry /= 10)
+    {
+        m_limbs.push_back(carry % 10);
+    }
+
+    if (carry < 0)
+    {
+        m_limbs.push_back(Limb(carry));
+    }
+
+    while (!m_limbs.empty() && m_limbs.back() == 0)
+    {
+        m_limbs.pop_back();
+    }
+
+    m_bound = 9;
+    if (!m_limbs.empty())
+    {
+        m_bound = std::max<int64_t>(m_bound, std::abs(m_limbs.back()));
+    }
+}
+
+LongMath LongAccumulator::value() const
+{
+    LongMath::Buffer digits;
+    digits.reserve(m_limbs.size() + 8);
+
+    int64_t carry = 0;
+
+    for (auto limb : m_limbs)
+    {
+        const int64_t v = limb + carry;
+        carry = floor_div10(v);
+        digits.push_back(char(v - 10 * carry));
+    }
+
+    if (carry >= 0)
+    {
+        for (; carry > 0; carry /= 10)
+        {
+            digits.push_back(carry % 10);
+        }
+        return LongMath(std::move(digits));
+    }
+
+    // digits + carry * 10^n, with a negative carry
+    const size_t n = digits.size();
+    return LongMath(std::move(digits)) + (LongMath(carry) << n);
+}
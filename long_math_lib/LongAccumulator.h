@@ -0,0 +1,72 @@
+#ifndef _LONG_ACCUMULATOR_H_
+#define _LONG_ACCUMULATOR_H_
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+#include "LongMath.h"
+
+/*
+ * Sum of many LongMath terms without carry propagation on every addition.
+ *
+ * Each decimal position gets a signed 16-bit limb, so a term is added or
+ * subtracted digit by digit with no carries, leaving headroom for thousands
+ * of terms. Carries are propagated (normalize()) only when the next term
+ * could overflow a limb, and when the value is read.
+ *
+ *     LongAccumulator acc;
+ *     for (...)
+ *         acc.addProduct(a[i], b[i]);    // dot product, no LongMath temporaries
+ *     LongMath total = acc.value();
+ */
+class LongAccumulator
+{
+public:
+    using Limb = int16_t;
+
+    static const int64_t LIMB_MAX = std::numeric_limits<Limb>::max();
+
+    /*
+     * Products of factors longer than this are digit convolutions by
+     * Polynomial<int64_t> multiplication (Karatsuba or a transform), whose
+     * digits are carried once and added straight into the limbs
+     */
+    static const size_t SCHOOLBOOK_LIMIT = 32;
+
+    LongAccumulator();
+    explicit LongAccumulator(LongMath const & initial);
+
+    LongAccumulator & operator+=(LongMath const & lm)       { add(lm.view(), false); return *this; }
+    LongAccumulator & operator-=(LongMath const & lm)       { add(lm.view(), true);  return *this; }
+    LongAccumulator & operator+=(LongMath::View const & v)  { add(v, false);         return *this; }
+    LongAccumulator & operator-=(LongMath::View const & v)  { add(v, true);          return *this; }
+
+    // this += a * b
+    void addProduct(LongMath const & a, LongMath const & b);
+
+    // Carry-propagated sum
+    LongMath value() const;
+    operator LongMath() const { return value(); }
+
+    // Propagates the carries in place, restoring the full headroom
+    void normalize();
+
+    void clear();
+
+    // Bound on the absolute value of any limb
+    int64_t bound() const { return m_bound; }
+
+private:
+    void add(LongMath::View const & v, bool negate);
+
+    // this += sign * x * y for digits x and y, by a digit convolution
+    void addConvolution(LongMath::Buffer const & x, LongMath::Buffer const & y, Limb sign);
+    void reserveHeadroom(int64_t increase);
+
+private:
+    std::vector<Limb> m_limbs;
+    int64_t           m_bound;
+};
+
+#endif
@@ -1,8 +1,14 @@
 
 #include "LongMath.h"
 #include "Polynomial.h"
+#include "DigitKernels.h"
 
 #include <assert.h>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 
 void remove_trailing_zeros(LongMath::Buffer & v)
@@ -17,87 +23,171 @@ void remove_trailing_zeros(LongMath::Buffer & v)
     }
 }
 
-LongMath LongMath::operator+ (const LongMath & lm) const
+#if defined(__SSE2__)
+/*
+ * Reverses the order of the 16 bytes of a SSE register
+ */
+inline __m128i reverse_bytes(__m128i x)
 {
-    LongMath new_lm(*this);
+    x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+    x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+    x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+}
+#endif
 
-    const auto size_l = new_lm.value.size();
-    const auto size_r = lm.value.size();
-    const auto max_size = std::max(size_l, size_r);
-    int carry = 0;
+/*
+ * Writes len digits (least significant first) as ASCII text, most significant first
+ */
+void digits_to_text(const char * digits, size_t len, char * text)
+{
+    size_t i = 0;
 
-    for (size_t i = 0; i < max_size || carry > 0; ++i)
-    {
-        const auto left  = (i < size_l) ? new_lm.value[i] : 0;
-        const auto right = (i < size_r) ? lm.value[i] : 0; 
-        
-        const div_t result = div(left + right + carry, 10 );
-                
-        if (i < size_l)
-        {
-            new_lm.value[i] = result.rem;
-        }
-        else
-        {
-            new_lm.value.push_back(result.rem);
-        }
+#if defined(__SSE2__)
+    const __m128i zero_char = _mm_set1_epi8('0');
 
-        carry = result.quot;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(digits + len - i - 16));
+        block = _mm_add_epi8(reverse_bytes(block), zero_char);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(text + i), block);
     }
+#endif
 
-    return new_lm;    
+    for (; i < len; ++i)
+    {
+        text[i] = digits[len - i - 1] + '0';
+    }
 }
 
-LongMath LongMath::operator- (const LongMath & lm) const
+/*
+ * Inverse of digits_to_text, the text is expected to be validated
+ */
+void text_to_digits(const char * text, size_t len, char * digits)
 {
-    LongMath res;
-    
-    if (isNegative() != lm.isNegative())
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero_char = _mm_set1_epi8('0');
+
+    for (; i + 16 <= len; i += 16)
     {
-        res = *this + lm;
-        res.setSign(sign);
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+        block = reverse_bytes(_mm_sub_epi8(block, zero_char));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(digits + len - i - 16), block);
     }
-    else
+#endif
+
+    for (; i < len; ++i)
     {
-        LongMath const *left = this, *right = &lm;
+        digits[len - i - 1] = text[i] - '0';
+    }
+}
 
-        if (left->absCompare(*right) == -1)
-        { 
-            left = &lm;
-            right = this;
-        }
+/*
+ * Length of the run of decimal digits at the beginning of [first, last)
+ */
+size_t count_digits(const char * first, const char * last)
+{
+    const size_t len = last - first;
+    size_t i = 0;
 
-        res.setSign(left->getSign());
+#if defined(__SSE2__)
+    const __m128i below = _mm_set1_epi8('0' - 1);
+    const __m128i above = _mm_set1_epi8('9' + 1);
 
-        const auto size_l = left->value.size();
-        const auto size_r = right->value.size();
-        char carry = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i));
+        // bytes >= 0x80 are negative in a signed compare, so they fail too
+        const __m128i is_digit = _mm_and_si128( _mm_cmpgt_epi8(block, below)
+                                              , _mm_cmplt_epi8(block, above));
+        const unsigned mask = ~_mm_movemask_epi8(is_digit) & 0xFFFF;
 
-        for (size_t i = 0; i < size_l; ++i)
+        if (mask != 0)
         {
-            char l = left->value[i] - carry;
-            char r = (i < size_r) ? right->value[i] : 0; 
-            
-            if (l < r)
-            {
-                l += 10;
-                carry = 1;
-            }
-            else
-            {
-                carry = 0;
-            }
-      
-            res.value.push_back(l - r);
+            return i + __builtin_ctz(mask);
         }
-       
-        remove_trailing_zeros(res.value); 
     }
- 
-    return res;   
+#endif
+
+    for (; i < len; ++i)
+    {
+        if (first[i] < '0' || first[i] > '9')
+            break;
+    }
+    return i;
+}
+
+LongMath LongMath::addAbs(View l, View r, Sign s)
+{
+    View const & longer  = (l.size >= r.size) ? l : r;
+    View const & shorter = (l.size >= r.size) ? r : l;
+
+    const size_t size = longer.size;
+    Buffer sum(size + 1);
+
+    sum[size] = digit_kernels().add( longer.digits, size
+                                   , shorter.digits, shorter.size
+                                   , sum.data());
+    if (sum[size] == 0)
+    {
+        sum.pop_back();
+    }
+
+    return LongMath(std::move(sum), s);
+}
+
+LongMath LongMath::subAbs(const LongMath & l, const LongMath & r, Sign s)
+{
+    Buffer diff(l.value.size());
+
+    // extra digits of r can only be leading zeros
+    digit_kernels().sub( l.value.data(), l.value.size()
+                       , r.value.data(), std::min(l.value.size(), r.value.size())
+                       , diff.data());
+
+    // the constructor drops the leading zeros
+    return LongMath(std::move(diff), s);
+}
+
+LongMath LongMath::operator+ (const LongMath & lm) const
+{
+    if (isNegative() == lm.isNegative())
+    {
+        return addAbs(view(), lm.view(), sign);
+    }
+    
+    // a + (-b) == a - b
+    if (absCompare(lm) >= 0)
+    {
+        return subAbs(*this, lm, sign);
+    }
+    
+    return subAbs(lm, *this, lm.sign);
+}
+
+LongMath LongMath::operator- (const LongMath & lm) const
+{
+    if (isNegative() != lm.isNegative())
+    {
+        return addAbs(view(), lm.view(), sign);
+    }
+
+    if (absCompare(lm) >= 0)
+    {
+        return subAbs(*this, lm, sign);
+    }
+
+    return subAbs(lm, *this, isNegative() ? Sign::POS : Sign::NEG);
 }
 
 LongMath LongMath::operator* (const LongMath & right_factor) const
+{
+    return (*this) * right_factor.view();
+}
+
+LongMath LongMath::operator* (const View & right_factor) const
 {
     LongMath left_factor(*this);
 
@@ -124,109 +214,135 @@ std::ostream & operator<<(std::ostream & os, LongMath const & lm)
         char sign =  (lm.sign == LongMath::Sign::NEG) ? '-' : '+';              
         os << sign;
     }
-        auto it = lm.value.rbegin(), it_end = lm.value.rend();
-        for(; it != it_end; ++it)
-        {
-                os << (char)(*it + 48);
-        }
-        return os;
-}
 
-int8_t LongMath::compare(const LongMath & lm) const
-{
-    bool thisIsZero = this->isZero();
-    bool lmIsZero = lm.isZero();
+    // Convert by blocks into a local buffer instead of char by char
+    const size_t BLOCK = 4096;
+    char text[BLOCK];
 
-    if (thisIsZero && lmIsZero)
-    {
-        return 0;
-    }
-    else if (!thisIsZero && lmIsZero)
-    {
-        return isNegative() ? -1 : 1;
-    }
-    else if (thisIsZero && !lmIsZero)
-    {
-        return lm.isNegative() ? 1 : -1;
-    }
-    else if (this->isNegative() && !lm.isNegative())
-    {
-        return -1;
-    }
-    else if (!this->isNegative() && lm.isNegative())
+    size_t remaining = lm.value.size();
+    while (remaining > 0)
     {
-        return 1;
+        const size_t len = std::min(remaining, BLOCK);
+        remaining -= len;
+
+        digits_to_text(lm.value.data() + remaining, len, text);
+        os.write(text, len);
     }
-    else if (this->value.size() < lm.value.size())
+    return os;
+}
+
+std::to_chars_result to_chars(char * first, char * last, LongMath const & lm)
+{
+    const size_t len = lm.value.size();
+    const bool negative = len != 0 && lm.isNegative();
+    const size_t needed = (negative ? 1 : 0) + std::max<size_t>(len, 1);
+
+    if (last < first || size_t(last - first) < needed)
     {
-        return this->isNegative() ? 1 : -1;
+        return { last, std::errc::value_too_large };
     }
-    else if (this->value.size() > lm.value.size())
+
+    if (len == 0)
     {
-        return this->isNegative() ? -1 : 1;
+        *first = '0';
+        return { first + 1, std::errc() };
     }
-    else
+
+    if (negative)
     {
-        auto it1 = value.rbegin(), it2 = lm.value.rbegin();
-        
-        for(; it1!=value.rend(); ++it1, ++it2)
-        {
-            if (*it1 < *it2)
-            {
-                return this->isNegative() ? 1 : -1;
-            }
-            else if (*it1 > *it2)
-            {
-                return this->isNegative() ? -1 : 1;
-            }
-        }
+        *first++ = '-';
     }
-    
-    return 0;
+
+    digits_to_text(lm.value.data(), len, first);
+    return { first + len, std::errc() };
 }
 
-int8_t LongMath::absCompare(const LongMath & lm) const
+std::from_chars_result from_chars(const char * first, const char * last, LongMath & lm)
 {
-    bool thisIsZero = this->isZero();
-    bool lmIsZero = lm.isZero();
+    const char * it = first;
+    LongMath::Sign sign = LongMath::Sign::POS;
 
-    if (thisIsZero && lmIsZero)
+    if (it != last && (*it == '-' || *it == '+'))
     {
-        return 0;
+        sign = (*it == '-') ? LongMath::Sign::NEG : LongMath::Sign::POS;
+        ++it;
     }
-    else if (!thisIsZero && lmIsZero)
+
+    const size_t len = count_digits(it, last);
+    if (len == 0)
     {
-        return 1;
+        return { first, std::errc::invalid_argument };
     }
-    else if (thisIsZero && lmIsZero)
+
+    // leading zeros are not stored
+    size_t skip = 0;
+    while (skip < len && it[skip] == '0')
     {
-        return -1;
+        ++skip;
     }
-    else if (this->value.size() < lm.value.size())
+
+    lm.value.resize(len - skip);
+    text_to_digits(it + skip, len - skip, lm.value.data());
+    lm.sign = sign;
+    lm.normalize();
+
+    return { it + len, std::errc() };
+}
+
+int8_t LongMath::compare(const LongMath & lm) const
+{
+    // zero is always positive, so different signs decide on their own
+    if (sign != lm.sign)
     {
-        return -1;
+        return isNegative() ? -1 : 1;
     }
-    else if (this->value.size() > lm.value.size())
+
+    const int8_t abs = absCompare(lm);
+    return isNegative() ? -abs : abs;
+}
+
+int8_t LongMath::absCompare(const LongMath & lm) const
+{
+    // without leading zeros the longer number is the larger one
+    if (value.size() != lm.value.size())
     {
-        return 1;
+        return value.size() < lm.value.size() ? -1 : 1;
     }
-    else
+
+    return digit_kernels().compare(value.data(), lm.value.data(), value.size());
+}
+
+size_t LongMath::hash() const
+{
+    size_t h = hashCache.digits.load(std::memory_order_relaxed);
+
+    if (h == 0)
     {
-        auto it1 = value.rbegin(), it2 = lm.value.rbegin();
-        
-        for(; it1!=value.rend(); ++it1, ++it2)
+        // 8 digits per step, multiply-xorshift mixing
+        const uint64_t k = 0x9E3779B97F4A7C15ull;
+        uint64_t acc = value.size() * k;
+        size_t i = 0;
+
+        for (; i + 8 <= value.size(); i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, value.data() + i, 8);
+            acc = (acc ^ word) * k;
+            acc ^= acc >> 32;
+        }
+
+        for (; i < value.size(); ++i)
         {
-            if (*it1 < *it2)
-            {
-                return -1;
-            }
-            else if (*it1 > *it2)
-            {
-                return 1;
-            }
+            acc = (acc ^ uint8_t(value[i])) * k;
         }
+        acc ^= acc >> 29;
+
+        // 0 means "not computed"
+        h = (acc != 0) ? acc : 1;
+        hashCache.digits.store(h, std::memory_order_relaxed);
     }
-    return 0;
+
+    return isNegative() ? ~h : h;
 }
 
 bool LongMath::operator< (const LongMath & lm) const
@@ -242,20 +358,38 @@ bool LongMath::operator> (const LongMath & lm) const
 const size_t LongMath::TRIGGER_STRASSEN;
 const size_t LongMath::TRIGGER_KARATSUBA;
 
-void multiply(LongMath::Buffer & left_factor, int right_factor);
+void multiply(LongMath::Buffer & left_factor, uint32_t right_factor);
 
 void LongMath::standardMultiplication(const LongMath & factor) 
 {
+    standardMultiplication(factor.view());
+}
+
+void LongMath::strassenMultiplication(const LongMath & right_factor)
+{
+    strassenMultiplication(right_factor.view());
+}
+
+void LongMath::karatsubaMultiplication(const LongMath & right_factor)
+{
+    karatsubaMultiplication(right_factor.view());
+}
+
+void LongMath::standardMultiplication(const View & factor) 
+{
+    const bool negative = isNegative() != factor.isNegative();
+    sign = Sign::POS;
+
     LongMath result(0);
 
     unsigned int index = 0;
-    for (; index < factor.value.size(); ++index)
+    for (; index < factor.size; ++index)
     {
-        LongMath tmp = ((*this) * factor.value[index]) << index;
+        LongMath tmp = ((*this) * factor.digits[index]) << index;
         result = result + tmp;
     }
 
-    if (factor.isNegative())
+    if (negative)
     {
         result.opposite();
     }
@@ -263,104 +397,145 @@ void LongMath::standardMultiplication(const LongMath & factor)
     *this = result;
 }
 
-void LongMath::strassenMultiplication(const LongMath & right_factor)
+/*
+ * Digits of the integer sum of p[i] * 10^i, p holding rounded digit products
+ */
+static LongMath::Buffer carry_digits(Polynomial<double> const & p)
 {
-    Polynomial<double> p1, p2;
-    p1.assign(value); p2.assign(right_factor.value);
-    
-    p1.FFT_multiplication(p2);
-   
-    // Normalize to 10 basis 
-    LongMath result;
-    uint8_t carry = 0;
-    
-    for(size_t i = 0; i<p1.size(); ++i)
+    LongMath::Buffer digits;
+    digits.reserve(p.size() + 2);
+
+    int64_t carry = 0;
+    for(size_t i = 0; i<p.size(); ++i)
     {
-        div_t d = div(round(p1[i]) + carry, 10);
+        lldiv_t d = lldiv(llround(p[i]) + carry, 10);
         carry = d.quot; 
-        result.value.push_back(d.rem);
+        digits.push_back(d.rem);
     }
     
-    if(carry != 0)
+    while(carry != 0)
     {
-        result.value.push_back(carry);
+        digits.push_back(carry % 10);
+        carry /= 10;
     }
+    return digits;
+}
+
+void LongMath::strassenMultiplication(const View & right_factor)
+{
+    const bool negative = isNegative() != right_factor.isNegative();
+
+    Polynomial<double> p1, p2;
+    p1.assign(value); p2.assign(right_factor.digits, right_factor.digits + right_factor.size);
     
-    *this = result;
-    
-    remove_trailing_zeros(value);
+    p1.FFT_multiplication(p2);
+   
+    // Normalize to 10 basis 
+    *this = LongMath(carry_digits(p1));
 
-    if(right_factor.isNegative())
+    if(negative)
             opposite();
 }
 
-void LongMath::karatsubaMultiplication(const LongMath & right_factor)
+LongMath::Transformed LongMath::transformed(size_t factor_digits) const
+{
+    Polynomial<double> digits;
+    digits.assign(value);
+
+    return Transformed(std::make_shared<const TransformedPolynomial<double>>(digits, factor_digits), sign);
+}
+
+void LongMath::strassenMultiplication(const Transformed & right_factor)
+{
+    const bool negative = isNegative() != (right_factor.getSign() == Sign::NEG);
+
+    Polynomial<double> digits;
+    digits.assign(value);
+
+    *this = LongMath(carry_digits(right_factor.digits().multiply(digits)));
+
+    if(negative)
+        opposite();
+}
+
+void LongMath::karatsubaMultiplication(const View & right_factor)
 {  
-        LongMath r(right_factor);
-        if (r.value.size() < value.size())
-        {
-            r.value.resize(value.size());
-        }
-        else if (r.value.size() > value.size())
-        {
-            value.resize(r.value.size());
-        }      
- 
-        *this = karatsubaRecursive (*this, r);
+        const bool negative = isNegative() != right_factor.isNegative();
+
+        *this = karatsubaRecursive(view(), right_factor);
         
-        if(right_factor.isNegative())
+        if(negative)
             opposite();
-    
-        remove_trailing_zeros(value);
 }
 
-LongMath LongMath::karatsubaRecursive(const LongMath & left_factor, const LongMath & right_factor)
+/*
+ * The digits [first, first + len) without their leading zeros
+ */
+static LongMath::View digit_range(const char * first, size_t len)
+{
+    while (len > 0 && first[len - 1] == 0)
+    {
+        --len;
+    }
+    return LongMath::View{ first, len, LongMath::Sign::POS };
+}
+
+LongMath LongMath::karatsubaRecursive(View left_factor, View right_factor)
 {
-    const size_t left_size = left_factor.value.size();
-    const size_t right_size = right_factor.value.size();
+    const size_t left_size = left_factor.size;
+    const size_t right_size = right_factor.size;
 
-    if (left_size == 1 && right_size == 1)
+    if (left_size == 0 || right_size == 0)
     {
-        return LongMath(left_factor.value[0] * right_factor.value[0]);
+        return LongMath();
     }
-    else if (left_size == 1)
+    else if (left_size == 1 && right_size == 1)
     {
-        return right_factor * left_factor.value[0];
+        return LongMath(left_factor.digits[0] * right_factor.digits[0]);
     }
-    else if (right_size == 1)
+    else if (left_size == 1 || right_size == 1)
     {
-        return left_factor * right_factor.value[0];
+        View const & longer = (left_size == 1) ? right_factor : left_factor;
+        const int digit = (left_size == 1) ? left_factor.digits[0] : right_factor.digits[0];
+
+        LongMath product(Buffer(longer.digits, longer.digits + longer.size));
+        multiply(product.value, digit);
+        product.normalize();
+        return product;
     }
 
-    size_t split_l = ceil(left_size / 2);
-    size_t split_r = ceil(right_size / 2);
-    size_t deg = floor(left_size / 2);
+    // both factors are split at the same power of 10, the halves drop their leading zeros
+    const size_t deg = std::max(left_size, right_size) / 2;
+    const size_t split_l = std::min(deg, left_size);
+    const size_t split_r = std::min(deg, right_size);
 
-    LongMath x2(left_factor.value.begin(), left_factor.value.begin() + split_l);
-    LongMath x1(left_factor.value.begin() + split_l, left_factor.value.end());
+    const View x2 = digit_range(left_factor.digits, split_l);
+    const View x1 = digit_range(left_factor.digits + split_l, left_size - split_l);
 
-    LongMath y2(right_factor.value.begin(), right_factor.value.begin() + split_r);
-    LongMath y1(right_factor.value.begin() + split_r, right_factor.value.end());
+    const View y2 = digit_range(right_factor.digits, split_r);
+    const View y1 = digit_range(right_factor.digits + split_r, right_size - split_r);
 
     LongMath a = karatsubaRecursive(x1, y1);
     LongMath c = karatsubaRecursive(x2, y2);
+
+    const LongMath x = addAbs(x1, x2, Sign::POS);
+    const LongMath y = addAbs(y1, y2, Sign::POS);
     
-    return  c + ((karatsubaRecursive(x1+x2, y1+y2) - a - c) << deg) + (a<< (2 * deg));
+    return  c + ((karatsubaRecursive(x.view(), y.view()) - a - c) << deg) + (a<< (2 * deg));
 }
 
 LongMath LongMath::operator<<(int power) const
 {
-    auto res = *this;
-    res.value.insert(res.value.end(), power, 0);
-
-    auto it = res.value.rbegin();
-    auto it_end = res.value.rend() - power;
-
-    for (; it != it_end; ++it)
+    // zero has no digits to shift
+    if (isZero())
     {
-        std::swap(*it, *(it + power));
+        return *this;
     }
 
+    auto res = *this;
+    res.value.insert(res.value.begin(), power, 0);
+    res.hashCache.reset();
+
     return res;
 }
 
@@ -378,31 +553,31 @@ LongMath LongMath::operator* (int right_factor) const
     }
 
     LongMath left_factor(*this);
-    multiply(left_factor.value, right_factor);
+    if (right_factor < 0)
+    {
+        left_factor.opposite();
+    }
+
+    multiply(left_factor.value, std::abs(int64_t(right_factor)));
+    left_factor.hashCache.reset();
 
     return left_factor;
 }
 
-void multiply(LongMath::Buffer & left_factor, int right_factor)
+void multiply(LongMath::Buffer & left_factor, uint32_t right_factor)
 {
-    int carry = 0;
-    LongMath::BufferIt it = left_factor.begin();
-
-    for (; it != left_factor.end(); ++it)
-    {
-        const int res = *it * right_factor + carry;
-        carry = res / 10;
-        *it = res % 10;
-    }
+    uint64_t carry = digit_kernels().mulWord(left_factor.data(), left_factor.size(), right_factor);
 
-    if (carry > 0)
+    for (; carry > 0; carry /= 10)
     {
-        left_factor.push_back(carry);
+        left_factor.push_back(carry % 10);
     }
 }
 
 void LongMath::setFromInt(int64_t val)
 {
+    sign = Sign::POS;
+
     if (val == 0)
     {
 /*        sign = Sign::POS;
@@ -419,17 +594,31 @@ void LongMath::setFromInt(int64_t val)
         sign = Sign::POS;
     }
         
-    div_t result = div(val, 10);
+    lldiv_t result = lldiv(val, 10);
     
     while (result.quot != 0 || result.rem != 0)
     {
         value.push_back(result.rem);
-        result = div(result.quot, 10);
+        result = lldiv(result.quot, 10);
+    }
+}
+
+void LongMath::normalize()
+{
+    remove_trailing_zeros(value);
+
+    if (value.empty())
+    {
+        sign = Sign::POS;
     }
+
+    hashCache.reset();
 }
 
 void LongMath::setFromString(std::string const & val)
 {
+    sign = Sign::POS;
+
     if (val.empty())
     {
    /*     sign = Sign::POS;
@@ -437,24 +626,9 @@ void LongMath::setFromString(std::string const & val)
         return;
     }
 
-    auto it = val.rbegin();
-    auto it_end = val.rend();
-    
-    if (val[0] == '-')
-    {
-        sign = Sign::NEG;
-        it_end--;
-    }
-    else
-    {
-        sign = Sign::POS;
-    }
+    const char * end = val.data() + val.size();
+    const std::from_chars_result res = from_chars(val.data(), end, *this);
 
-    for (; it != it_end; ++it)
-    {
-        if (!isdigit(*it))
-            throw std::invalid_argument("Not a digit");
-
-        value.push_back(*it - 48);
-    }
+    if (res.ec != std::errc() || res.ptr != end)
+        throw std::invalid_argument("Not a digit");
 }
@@ -1,8 +1,23 @@
+#ifndef _LONG_MATH_H_
+#define _LONG_MATH_H_
+
 #include <iostream>
 #include <stdlib.h>
 #include <vector>
 #include <algorithm>
-
+#include <charconv>
+#include <atomic>
+#include <memory>
+
+template<typename> class TransformedPolynomial;
+
+/*
+ * Arbitrary precision signed integer.
+ *
+ * Values are kept canonical: no leading zero digits and zero is an empty,
+ * positive buffer. Every constructor and operation maintains this, so zero
+ * tests and most comparisons are O(1).
+ */
 class LongMath
 {
 public:
@@ -13,6 +28,19 @@ public:
     
     enum class Sign : char { POS = '+', NEG='-' };
 
+    /*
+     * Read-only view of digits owned by someone else (a LongMath, a memory-mapped
+     * file, ...). It can be used as the right factor of a multiplication.
+     */
+    struct View
+    {
+        const char * digits;
+        size_t       size;
+        Sign         sign;
+
+        bool isNegative() const { return sign == Sign::NEG; }
+    };
+
     LongMath() 
         :/* value(1, 0)
         , */sign(Sign::POS)
@@ -21,12 +49,23 @@ public:
     LongMath(Buffer const & buf, Sign const & s = Sign::POS) 
         : value(buf)
         , sign(s)
-    {}
+    {
+        normalize();
+    }
+
+    LongMath(Buffer && buf, Sign const & s = Sign::POS) 
+        : value(std::move(buf))
+        , sign(s)
+    {
+        normalize();
+    }
 
     LongMath(Buffer::const_iterator begin, Buffer::const_iterator end, Sign const & s = Sign::POS) 
         : value(begin, end)
         , sign(s)
-    {}
+    {
+        normalize();
+    }
 
     LongMath(std::string const & val)
     {
@@ -38,9 +77,13 @@ public:
         setFromInt(val);
     }
     
-    void setSign(Sign const & s ) { sign = s;    }
+    void setSign(Sign const & s ) { sign = value.empty() ? Sign::POS : s; }
     Sign const & getSign() const  { return sign; }
 
+    // Decimal digits, least significant first
+    Buffer const & getValue() const { return value; }
+    View           view()     const { return View{ value.data(), value.size(), sign }; }
+
     bool operator== (const LongMath & lm) const
     {   
         return compare(lm) == 0;       
@@ -63,20 +106,23 @@ public:
     LongMath operator+ (const LongMath & lm) const;
     LongMath operator- (const LongMath & lm) const;
     LongMath operator* (const LongMath & right_factor) const;
+    LongMath operator* (const View & right_factor) const;
    
     int8_t compare(const LongMath & lm) const;
     int8_t absCompare(const LongMath & lm) const;
 
     bool isNegative() const { return sign == Sign::NEG; }
-    bool isZero() const
-    { 
-        auto it =  std::find_if(value.begin(), value.end(), [](char const & d) { return d != 0; });
-        return it == value.end();
-    }
+    bool isZero()     const { return value.empty(); }
+
+    // Zero stays positive
+    void opposite() { if (!value.empty()) sign = (sign == Sign::NEG) ? Sign::POS : Sign::NEG; }
 
-    void opposite() { sign = (sign == Sign::NEG) ? Sign::POS : Sign::NEG; }
+    // Hash of the value, the digits part is computed once and cached
+    size_t hash() const;
 
     friend std::ostream & operator<<(std::ostream &, LongMath const &);
+    friend std::to_chars_result   to_chars  (char * first, char * last, LongMath const & lm);
+    friend std::from_chars_result from_chars(const char * first, const char * last, LongMath & lm);
 
     LongMath operator<<(int power) const;
 
@@ -84,20 +130,106 @@ public:
     void strassenMultiplication (const LongMath & right_factor);
     void karatsubaMultiplication(const LongMath & right_factor);
     void standardMultiplication (const LongMath & right_factor);
+    void strassenMultiplication (const View & right_factor);
+    void karatsubaMultiplication(const View & right_factor);
+    void standardMultiplication (const View & right_factor);
+
+    /*
+     * A constant factor whose digits are transformed once, for FFT
+     * multiplications by factors of up to factor_digits digits (longer ones
+     * are split). It keeps the sign of the constant; copies share the
+     * transformed digits.
+     */
+    class Transformed
+    {
+    public:
+        Sign const & getSign() const { return sign; }
+
+        TransformedPolynomial<double> const & digits() const { return *transform; }
+
+    private:
+        friend class LongMath;
+
+        Transformed(std::shared_ptr<const TransformedPolynomial<double>> t, Sign s)
+            : transform(std::move(t))
+            , sign(s)
+        {}
+
+        std::shared_ptr<const TransformedPolynomial<double>> transform;
+        Sign sign;
+    };
+
+    Transformed transformed(size_t factor_digits) const;
+    void strassenMultiplication (const Transformed & right_factor);
 
 private:
-    LongMath karatsubaRecursive(const LongMath & left_factor, const LongMath & right_factor);
+    // |l| + |r| and |l| - |r| (with |l| >= |r|), the result gets the sign s
+    static LongMath addAbs(View l, View r, Sign s);
+    static LongMath subAbs(const LongMath & l, const LongMath & r, Sign s);
+
+    // |l| * |r|, the halves of the factors are views into their digits
+    static LongMath karatsubaRecursive(View left_factor, View right_factor);
 
     void setFromInt(int64_t val);
     void setFromString(std::string const & val);
 
+    // Restores the canonical form after value has been modified in place
+    void normalize();
+
+    /*
+     * Digits hash computed on first use, 0 when not computed yet. Atomic so
+     * that hashing a shared const value from several threads is well defined.
+     */
+    struct HashCache
+    {
+        HashCache() : digits(0) {}
+        HashCache(HashCache const & c) : digits(c.digits.load(std::memory_order_relaxed)) {}
+
+        HashCache & operator=(HashCache const & c)
+        {
+            digits.store(c.digits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+
+        void reset() { digits.store(0, std::memory_order_relaxed); }
+
+        std::atomic<size_t> digits;
+    };
+
 private:
     static const size_t TRIGGER_STRASSEN = 100;
     static const size_t TRIGGER_KARATSUBA = 10;
 
     Buffer value;
     Sign   sign;
+
+    mutable HashCache hashCache;
 };
+
+namespace std
+{
+    template<>
+    struct hash<LongMath>
+    {
+        size_t operator()(LongMath const & lm) const { return lm.hash(); }
+    };
+}
     
 std::ostream & operator<<(std::ostream & os, LongMath const & lm);
 
+/*
+ * Writes lm in decimal into [first, last) without allocating: '-' for negative
+ * values, no sign otherwise, "0" for zero. Returns errc::value_too_large and
+ * last if the range is too small, as std::to_chars does.
+ */
+std::to_chars_result to_chars(char * first, char * last, LongMath const & lm);
+
+/*
+ * Parses an optional '-' or '+' followed by decimal digits from [first, last).
+ * Stops at the first non-digit. Returns errc::invalid_argument and leaves lm
+ * untouched if there are no digits. The digit buffer of lm is reused, so no
+ * allocation happens when its capacity suffices.
+ */
+std::from_chars_result from_chars(const char * first, const char * last, LongMath & lm);
+
+#endif
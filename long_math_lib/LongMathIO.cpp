@@ -0,0 +1,334 @@
+
+#include "LongMathIO.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char     LONG_MATH_MAGIC[4]  = { 'L', 'M', 'T', 'H' };
+static const size_t   LONG_MATH_IO_BLOCK  = 1 << 20;
+static const uint64_t LONG_MATH_PACKED_MAX = 10000000000000000000ull;   // 10^19
+
+/*
+ * Whether every limb of a payload is a decimal digit
+ */
+static bool valid_digits(const char * digits, size_t len)
+{
+    char invalid = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        invalid |= static_cast<unsigned char>(digits[i]) > 9;
+    }
+    return !invalid;
+}
+
+/*
+ * PACKED limbs: digits [0, len) as one little endian 64-bit limb, and back
+ */
+static void pack_limb(const char * digits, size_t len, unsigned char * out)
+{
+    uint64_t v = 0;
+    for (size_t i = len; i-- > 0; )
+    {
+        v = 10 * v + digits[i];
+    }
+    for (size_t i = 0; i < 8; ++i)
+    {
+        out[i] = (v >> (8 * i)) & 0xff;
+    }
+}
+
+static bool unpack_limb(const unsigned char * in, char * digits)
+{
+    uint64_t v = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        v |= uint64_t(in[i]) << (8 * i);
+    }
+    if (v >= LONG_MATH_PACKED_MAX)
+        return false;
+
+    for (size_t i = 0; i < LONG_MATH_PACKED_DIGITS; ++i)
+    {
+        digits[i] = v % 10;
+        v /= 10;
+    }
+    return true;
+}
+
+void encode_header(unsigned char * header, LongMath::Sign sign, uint64_t count, LimbFormat format)
+{
+    std::memcpy(header, LONG_MATH_MAGIC, 4);
+    header[4] = LONG_MATH_FORMAT_VERSION & 0xff;
+    header[5] = LONG_MATH_FORMAT_VERSION >> 8;
+    header[6] = static_cast<unsigned char>(format);
+    header[7] = static_cast<unsigned char>(sign);
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        header[8 + i] = (count >> (8 * i)) & 0xff;
+    }
+}
+
+LimbFormat decode_header(const unsigned char * header, LongMath::Sign & sign, uint64_t & count)
+{
+    if (std::memcmp(header, LONG_MATH_MAGIC, 4) != 0)
+        throw std::runtime_error("Not a LongMath binary file");
+
+    const uint16_t version = header[4] | (header[5] << 8);
+    if (version != LONG_MATH_FORMAT_VERSION)
+        throw std::runtime_error("Unsupported LongMath format version " + std::to_string(version));
+
+    const LimbFormat format = static_cast<LimbFormat>(header[6]);
+    if (format != LimbFormat::DIGITS && format != LimbFormat::PACKED)
+        throw std::runtime_error("Unsupported LongMath limb size");
+
+    if (header[7] != '+' && header[7] != '-')
+        throw std::runtime_error("Invalid LongMath sign");
+
+    sign = static_cast<LongMath::Sign>(header[7]);
+
+    count = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        count |= uint64_t(header[8 + i]) << (8 * i);
+    }
+    return format;
+}
+
+void serialize(std::ostream & os, LongMath const & lm, LimbFormat format)
+{
+    unsigned char header[LONG_MATH_HEADER_SIZE];
+    LongMath::Buffer const & digits = lm.getValue();
+
+    if (format == LimbFormat::DIGITS)
+    {
+        encode_header(header, lm.getSign(), digits.size(), format);
+
+        os.write(reinterpret_cast<const char *>(header), LONG_MATH_HEADER_SIZE);
+        os.write(digits.data(), digits.size());
+    }
+    else
+    {
+        const size_t count = (digits.size() + LONG_MATH_PACKED_DIGITS - 1) / LONG_MATH_PACKED_DIGITS;
+        encode_header(header, lm.getSign(), count, format);
+        os.write(reinterpret_cast<const char *>(header), LONG_MATH_HEADER_SIZE);
+
+        // packed and written a block at a time
+        std::vector<unsigned char> block;
+        for (size_t limb = 0; limb < count && os; )
+        {
+            const size_t len = std::min(count - limb, LONG_MATH_IO_BLOCK / 8);
+            block.resize(8 * len);
+
+            for (size_t i = 0; i < len; ++i, ++limb)
+            {
+                const size_t first = limb * LONG_MATH_PACKED_DIGITS;
+                pack_limb(digits.data() + first, std::min(LONG_MATH_PACKED_DIGITS, digits.size() - first),
+                          block.data() + 8 * i);
+            }
+            os.write(reinterpret_cast<const char *>(block.data()), block.size());
+        }
+    }
+
+    if (!os)
+        throw std::runtime_error("Failed to write LongMath");
+}
+
+LongMath deserialize(std::istream & is)
+{
+    unsigned char header[LONG_MATH_HEADER_SIZE];
+    is.read(reinterpret_cast<char *>(header), LONG_MATH_HEADER_SIZE);
+
+    if (is.gcount() != LONG_MATH_HEADER_SIZE)
+        throw std::runtime_error("Truncated LongMath header");
+
+    LongMath::Sign sign;
+    uint64_t count;
+    const LimbFormat format = decode_header(header, sign, count);
+
+    // Grow block by block, so that a corrupted count cannot trigger a huge allocation
+    LongMath::Buffer digits;
+
+    if (format == LimbFormat::PACKED)
+    {
+        std::vector<unsigned char> block;
+        for (uint64_t limb = 0; limb < count; )
+        {
+            const size_t len = std::min<uint64_t>(count - limb, LONG_MATH_IO_BLOCK / 8);
+            block.resize(8 * len);
+            is.read(reinterpret_cast<char *>(block.data()), block.size());
+
+            if (size_t(is.gcount()) != block.size())
+                throw std::runtime_error("Truncated LongMath payload");
+
+            const size_t offset = digits.size();
+            digits.resize(offset + len * LONG_MATH_PACKED_DIGITS);
+
+            for (size_t i = 0; i < len; ++i, ++limb)
+            {
+                if (!unpack_limb(block.data() + 8 * i, digits.data() + offset + i * LONG_MATH_PACKED_DIGITS))
+                    throw std::runtime_error("Invalid LongMath limb");
+            }
+        }
+        return LongMath(std::move(digits), sign);
+    }
+
+    while (digits.size() < count)
+    {
+        const size_t offset = digits.size();
+        const size_t len = std::min<uint64_t>(count - offset, LONG_MATH_IO_BLOCK);
+
+        digits.resize(offset + len);
+        is.read(digits.data() + offset, len);
+
+        if (size_t(is.gcount()) != len)
+            throw std::runtime_error("Truncated LongMath payload");
+
+        if (!valid_digits(digits.data() + offset, len))
+            throw std::runtime_error("Invalid LongMath digit");
+    }
+
+    return LongMath(std::move(digits), sign);
+}
+
+void saveToFile(std::string const & path, LongMath const & lm, LimbFormat format)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f)
+        throw std::runtime_error("Cannot open " + path);
+
+    serialize(f, lm, format);
+}
+
+LongMath loadFromFile(std::string const & path)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+        throw std::runtime_error("Cannot open " + path);
+
+    return deserialize(f);
+}
+
+MappedLongMath::MappedLongMath(std::string const & path, bool check_digits)
+    : m_mapping(nullptr)
+    , m_length(0)
+    , m_view{ nullptr, 0, LongMath::Sign::POS }
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "Cannot open " + path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        const int err = errno;
+        close(fd);
+        throw std::system_error(err, std::generic_category(), "Cannot stat " + path);
+    }
+
+    m_length = st.st_size;
+    if (m_length < LONG_MATH_HEADER_SIZE)
+    {
+        close(fd);
+        throw std::runtime_error("Truncated LongMath header");
+    }
+
+    m_mapping = mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0);
+    const int err = errno;
+    close(fd);
+
+    if (m_mapping == MAP_FAILED)
+    {
+        m_mapping = nullptr;
+        throw std::system_error(err, std::generic_category(), "Cannot map " + path);
+    }
+
+    // Multiplication streams through the digits
+    madvise(m_mapping, m_length, MADV_SEQUENTIAL);
+
+    const unsigned char * bytes = static_cast<const unsigned char *>(m_mapping);
+    uint64_t count;
+
+    try
+    {
+        if (decode_header(bytes, m_view.sign, count) != LimbFormat::DIGITS)
+            throw std::runtime_error("Only DIGITS LongMath files can be mapped");
+
+        if (count > m_length - LONG_MATH_HEADER_SIZE)
+            throw std::runtime_error("Truncated LongMath payload");
+
+        // reads every page, hence only on request
+        if (check_digits && !valid_digits(reinterpret_cast<const char *>(bytes + LONG_MATH_HEADER_SIZE), count))
+            throw std::runtime_error("Invalid LongMath digit");
+    }
+    catch (...)
+    {
+        unmap();
+        throw;
+    }
+
+    m_view.digits = reinterpret_cast<const char *>(bytes + LONG_MATH_HEADER_SIZE);
+    m_view.size   = count;
+
+    // leading zeros are not stored by serialize(), but the view stays canonical anyway
+    while (m_view.size > 0 && m_view.digits[m_view.size - 1] == 0)
+        --m_view.size;
+    if (m_view.size == 0)
+        m_view.sign = LongMath::Sign::POS;
+}
+
+MappedLongMath::~MappedLongMath()
+{
+    unmap();
+}
+
+MappedLongMath::MappedLongMath(MappedLongMath && m)
+    : m_mapping(m.m_mapping)
+    , m_length(m.m_length)
+    , m_view(m.m_view)
+{
+    m.m_mapping = nullptr;
+    m.m_length = 0;
+    m.m_view = LongMath::View{ nullptr, 0, LongMath::Sign::POS };
+}
+
+MappedLongMath & MappedLongMath::operator=(MappedLongMath && m)
+{
+    if (this != &m)
+    {
+        unmap();
+        std::swap(m_mapping, m.m_mapping);
+        std::swap(m_length, m.m_length);
+        std::swap(m_view, m.m_view);
+    }
+    return *this;
+}
+
+LongMath MappedLongMath::toLongMath() const
+{
+    return LongMath(LongMath::Buffer(m_view.digits, m_view.digits + m_view.size), m_view.sign);
+}
+
+bool MappedLongMath::checkDigits() const
+{
+    return valid_digits(m_view.digits, m_view.size);
+}
+
+void MappedLongMath::unmap()
+{
+    if (m_mapping != nullptr)
+    {
+        munmap(m_mapping, m_length);
+        m_mapping = nullptr;
+        m_length = 0;
+        m_view = LongMath::View{ nullptr, 0, LongMath::Sign::POS };
+    }
+}
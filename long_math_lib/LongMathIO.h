@@ -0,0 +1,110 @@
+#ifndef _LONG_MATH_IO_H_
+#define _LONG_MATH_IO_H_
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+#include "LongMath.h"
+
+/*
+ * Binary on-disk format of a LongMath value, all fields little endian:
+ *
+ *     offset  size  field
+ *          0     4  magic "LMTH"
+ *          4     2  format version (LONG_MATH_FORMAT_VERSION)
+ *          6     1  bytes per limb, the LimbFormat
+ *          7     1  sign, '+' or '-'
+ *          8     8  number of limbs
+ *         16     n  limbs, least significant first
+ *
+ * Two limb formats:
+ *
+ *     DIGITS  one decimal digit per byte, the raw content of the LongMath
+ *             buffer: writing is a plain block copy and the payload can be
+ *             memory-mapped (MappedLongMath, OutOfCoreMultiplier)
+ *     PACKED  19 decimal digits per 64-bit limb, 2.4 times smaller than
+ *             DIGITS or the decimal text, for checkpoints that are only
+ *             read back by deserialize()
+ */
+static const uint16_t LONG_MATH_FORMAT_VERSION = 1;
+static const size_t   LONG_MATH_HEADER_SIZE    = 16;
+
+enum class LimbFormat : uint8_t { DIGITS = 1, PACKED = 8 };
+
+// Decimal digits per PACKED limb, 10^19 < 2^64
+static const size_t LONG_MATH_PACKED_DIGITS = 19;
+
+/*
+ * Header of LONG_MATH_HEADER_SIZE bytes, for code writing or reading the
+ * payload piecewise. decode_header() returns the limb format and throws
+ * std::runtime_error on a bad header.
+ */
+void       encode_header(unsigned char * header, LongMath::Sign sign, uint64_t count,
+                         LimbFormat format = LimbFormat::DIGITS);
+LimbFormat decode_header(const unsigned char * header, LongMath::Sign & sign, uint64_t & count);
+
+/*
+ * Writes lm to os in the binary format. Throws std::runtime_error if the
+ * stream fails.
+ */
+void serialize(std::ostream & os, LongMath const & lm, LimbFormat format = LimbFormat::DIGITS);
+
+/*
+ * Reads a value written by serialize(), in either limb format. The payload
+ * is streamed into the digit buffer in blocks. Throws std::runtime_error on
+ * a malformed or truncated input.
+ */
+LongMath deserialize(std::istream & is);
+
+void     saveToFile  (std::string const & path, LongMath const & lm, LimbFormat format = LimbFormat::DIGITS);
+LongMath loadFromFile(std::string const & path);
+
+/*
+ * Read-only LongMath backed by a memory-mapped DIGITS file. The digits are
+ * never copied: view() points straight into the mapping, so the value can
+ * be used as a multiplication operand as it is:
+ *
+ *     MappedLongMath m("huge.lm");
+ *     LongMath product = factor * m.view();
+ *
+ * Opening checks the header and the file size only, so that it does not
+ * read the whole payload (throws std::runtime_error when malformed, or for
+ * a PACKED file). check_digits also checks every digit as deserialize()
+ * does, faulting in every page; otherwise digits above 9 give meaningless
+ * results, and checkDigits() can be called later.
+ */
+class MappedLongMath
+{
+public:
+    explicit MappedLongMath(std::string const & path, bool check_digits = false);
+    ~MappedLongMath();
+
+    MappedLongMath(MappedLongMath const &) = delete;
+    MappedLongMath & operator=(MappedLongMath const &) = delete;
+
+    MappedLongMath(MappedLongMath && m);
+    MappedLongMath & operator=(MappedLongMath && m);
+
+    LongMath::View view() const { return m_view; }
+    operator LongMath::View() const { return m_view; }
+
+    size_t size()       const { return m_view.size; }
+    bool   isNegative() const { return m_view.isNegative(); }
+
+    // Copies the digits into a regular LongMath
+    LongMath toLongMath() const;
+
+    // Whether every digit is below 10, reading the whole mapping
+    bool checkDigits() const;
+
+private:
+    void unmap();
+
+private:
+    void *         m_mapping;
+    size_t         m_length;
+    LongMath::View m_view;
+};
+
+#endif
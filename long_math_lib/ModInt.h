@@ -0,0 +1,169 @@
+#ifndef _MOD_INT_H_
+#define _MOD_INT_H_
+
+#include <cstdint>
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <type_traits>
+
+/*
+ * Integer modulo an odd prime P < 2^30, kept in Montgomery form
+ * (x * 2^32 mod P), so that a multiplication is two integer products and a
+ * shift instead of a division. The form is internal: constructors take plain
+ * integers (negative ones too) and value() gives back the plain residue.
+ *
+ * P < 2^30 leaves room for the sums of the NTT butterflies (see NTT.h).
+ */
+template<uint32_t P>
+class ModInt
+{
+    static_assert(P % 2 == 1 && P < (1u << 30), "ModInt modulus must be odd and below 2^30");
+
+public:
+    static constexpr uint32_t MOD = P;
+
+    constexpr ModInt()
+        : m_value(0)
+    {}
+
+    constexpr ModInt(int64_t v)
+        : m_value(reduce(uint64_t(normalize(v)) * R2))
+    {}
+
+    // Residue in [0, P)
+    constexpr uint32_t value() const { return reduce(m_value); }
+
+    // Direct access to the Montgomery form x * 2^32 mod P
+    constexpr uint32_t montgomery() const { return m_value; }
+
+    static constexpr ModInt fromMontgomery(uint32_t m)
+    {
+        ModInt r;
+        r.m_value = m;
+        return r;
+    }
+
+    constexpr ModInt & operator+=(ModInt const & o)
+    {
+        m_value = fold(m_value + o.m_value);
+        return *this;
+    }
+
+    constexpr ModInt & operator-=(ModInt const & o)
+    {
+        m_value = fold(m_value + P - o.m_value);
+        return *this;
+    }
+
+    constexpr ModInt & operator*=(ModInt const & o)
+    {
+        m_value = reduce(uint64_t(m_value) * o.m_value);
+        return *this;
+    }
+
+    constexpr ModInt operator+(ModInt const & o) const { ModInt r(*this); r += o; return r; }
+    constexpr ModInt operator-(ModInt const & o) const { ModInt r(*this); r -= o; return r; }
+    constexpr ModInt operator*(ModInt const & o) const { ModInt r(*this); r *= o; return r; }
+
+    constexpr ModInt operator-() const { return ModInt() - *this; }
+
+    constexpr bool operator==(ModInt const & o) const { return m_value == o.m_value; }
+    constexpr bool operator!=(ModInt const & o) const { return m_value != o.m_value; }
+
+    constexpr ModInt pow(uint64_t e) const
+    {
+        ModInt r(1), b(*this);
+        for (; e != 0; e >>= 1)
+        {
+            if (e & 1)
+                r *= b;
+            b *= b;
+        }
+        return r;
+    }
+
+    // Multiplicative inverse (Fermat), P being prime; 0 has none
+    constexpr ModInt inverse() const { return pow(P - 2); }
+
+    /*
+     * Smallest generator of the multiplicative group: g^((P-1)/q) != 1 for
+     * every prime q dividing P - 1
+     */
+    static ModInt generator()
+    {
+        uint32_t factors[32];
+        size_t count = 0;
+
+        uint32_t rest = P - 1;
+        for (uint32_t q = 2; q * q <= rest; ++q)
+        {
+            if (rest % q == 0)
+            {
+                factors[count++] = q;
+                while (rest % q == 0)
+                    rest /= q;
+            }
+        }
+        if (rest > 1)
+            factors[count++] = rest;
+
+        for (uint32_t g = 2; ; ++g)
+        {
+            bool primitive = true;
+            for (size_t i = 0; i < count && primitive; ++i)
+                primitive = ModInt(g).pow((P - 1) / factors[i]) != ModInt(1);
+
+            if (primitive)
+                return ModInt(g);
+        }
+    }
+
+private:
+    // -P^-1 mod 2^32, by Newton iteration (each step doubles the correct bits)
+    static constexpr uint32_t negInverse()
+    {
+        uint32_t inv = P;
+        for (int i = 0; i < 4; ++i)
+            inv *= 2 - P * inv;
+        return 0u - inv;
+    }
+
+    static constexpr uint32_t NEG_INV = negInverse();
+    static constexpr uint64_t R2      = (0 - uint64_t(P)) % P;   // 2^64 mod P
+
+    // t * 2^-32 mod P, for t < P * 2^32
+    static constexpr uint32_t reduce(uint64_t t)
+    {
+        const uint32_t m = uint32_t(t) * NEG_INV;
+        return fold(uint32_t((t + uint64_t(m) * P) >> 32));
+    }
+
+    // u mod P for u < 2P, branch free: u - P wraps above u when u < P
+    static constexpr uint32_t fold(uint32_t u)
+    {
+        return std::min(u, u - P);
+    }
+
+    static constexpr uint32_t normalize(int64_t v)
+    {
+        const int64_t r = v % int64_t(P);
+        return uint32_t((r < 0) ? r + P : r);
+    }
+
+    uint32_t m_value;
+};
+
+template<typename T>
+struct is_mod_int : std::false_type {};
+
+template<uint32_t P>
+struct is_mod_int<ModInt<P>> : std::true_type {};
+
+template<uint32_t P>
+std::ostream & operator<<(std::ostream & os, ModInt<P> const & v)
+{
+    return os << v.value();
+}
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef _NTT_H_
+#define _NTT_H_
+
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+
+#include "ModInt.h"
+
+/*
+ * Number theoretic transform of 2^k points over Z/PZ, the exact counterpart
+ * of FFTPlan: the roots of unity are powers of a generator of the field, and
+ * the butterflies are Montgomery products (see ModInt), so that products of
+ * integer polynomials come out without any rounding.
+ *
+ * The forward transform is decimation in frequency from natural order to bit
+ * reversed order, the inverse one decimation in time back to natural order,
+ * so a convolution never permutes the data. Its output is in the order of
+ * the forward one only after the inverse: the bit reversed spectrum is only
+ * meant for pointwise products.
+ *
+ * Sizes must divide P - 1. Plans are immutable and cached by size, as
+ * FFTPlan ones.
+ */
+template<uint32_t P>
+class NTTPlan
+{
+public:
+    using Mod = ModInt<P>;
+
+    explicit NTTPlan(size_t n)
+        : m_size(n)
+    {
+        if (n == 0 || (n & (n - 1)) != 0 || (P - 1) % n != 0)
+            throw std::invalid_argument("NTT size must be a power of 2 dividing P - 1");
+
+        // [h + j] = w_2h^j for the butterflies of half size h
+        m_roots.resize(n);
+        m_inverse_roots.resize(n);
+
+        const Mod g = Mod::generator();
+        for (size_t h = 1; h < n; h <<= 1)
+        {
+            const Mod w     = g.pow((P - 1) / (2 * h));
+            const Mod w_inv = w.inverse();
+
+            Mod r(1), r_inv(1);
+            for (size_t j = 0; j < h; ++j)
+            {
+                m_roots[h + j]         = r;
+                m_inverse_roots[h + j] = r_inv;
+                r     *= w;
+                r_inv *= w_inv;
+            }
+        }
+
+        m_inverse_size = Mod(int64_t(n)).inverse();
+    }
+
+    size_t size() const { return m_size; }
+
+    // Natural order in, bit reversed order out
+    void forward(Mod * a) const
+    {
+        for (size_t h = m_size / 2; h >= 1; h >>= 1)
+        {
+            const Mod * w = m_roots.data() + h;
+
+            for (size_t i = 0; i < m_size; i += 2 * h)
+            {
+                for (size_t j = 0; j < h; ++j)
+                {
+                    const Mod u = a[i + j];
+                    const Mod v = a[i + j + h];
+                    a[i + j]     = u + v;
+                    a[i + j + h] = (u - v) * w[j];
+                }
+            }
+        }
+    }
+
+    // Bit reversed order in, natural order out, including the 1/n scaling
+    void inverse(Mod * a) const
+    {
+        for (size_t h = 1; h < m_size; h <<= 1)
+        {
+            const Mod * w = m_inverse_roots.data() + h;
+
+            for (size_t i = 0; i < m_size; i += 2 * h)
+            {
+                for (size_t j = 0; j < h; ++j)
+                {
+                    const Mod u = a[i + j];
+                    const Mod v = a[i + j + h] * w[j];
+                    a[i + j]     = u + v;
+                    a[i + j + h] = u - v;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < m_size; ++i)
+            a[i] *= m_inverse_size;
+    }
+
+    // Cyclic convolution of n points: a = a * b, b is overwritten
+    void convolve(Mod * a, Mod * b) const
+    {
+        forward(a);
+        forward(b);
+        for (size_t i = 0; i < m_size; ++i)
+            a[i] *= b[i];
+        inverse(a);
+    }
+
+    // Cached plan for n points, built on first use; thread safe
+    static NTTPlan const & get(size_t n)
+    {
+        static std::mutex mutex;
+        static std::map<size_t, std::unique_ptr<NTTPlan>> plans;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto & plan = plans[n];
+        if (!plan)
+            plan.reset(new NTTPlan(n));
+        return *plan;
+    }
+
+private:
+    size_t           m_size;
+    std::vector<Mod> m_roots;
+    std::vector<Mod> m_inverse_roots;
+    Mod              m_inverse_size;
+};
+
+/*
+ * Per-thread NTT buffers, as fft_workspace: at least n elements, kept for
+ * the next call
+ */
+const size_t NTT_WORKSPACE_SLOTS = 2;
+
+template<uint32_t P>
+ModInt<P> * ntt_workspace(size_t slot, size_t n)
+{
+    thread_local std::vector<ModInt<P>> buffers[NTT_WORKSPACE_SLOTS];
+
+    if (slot >= NTT_WORKSPACE_SLOTS)
+        throw std::out_of_range("NTT workspace slot out of range");
+
+    auto & b = buffers[slot];
+    if (b.size() < n)
+        b.resize(n);
+    return b.data();
+}
+
+/*
+ * Primes c * 2^k + 1 with 3 as a generator: NTTs of up to 2^23, 2^25 and
+ * 2^26 points. Their product is about 2^86.
+ */
+const uint32_t NTT_PRIME_1 = 998244353;   // 119 * 2^23 + 1
+const uint32_t NTT_PRIME_2 = 167772161;   //   5 * 2^25 + 1
+const uint32_t NTT_PRIME_3 = 469762049;   //   7 * 2^26 + 1
+
+// Longest convolution of a single three prime NTT, see crt_convolution
+const size_t CRT_CONVOLUTION_MAX = size_t(1) << 23;
+
+/*
+ * The x in (-m/2, m/2] congruent to x1, x2 and x3 modulo the three NTT
+ * primes, m being their product (Garner's algorithm)
+ */
+inline __int128 crt_combine(uint32_t x1, uint32_t x2, uint32_t x3)
+{
+    using M2 = ModInt<NTT_PRIME_2>;
+    using M3 = ModInt<NTT_PRIME_3>;
+
+    static const M2 p1_inv  = M2(NTT_PRIME_1).inverse();
+    static const M3 p12_inv = (M3(NTT_PRIME_1) * M3(NTT_PRIME_2)).inverse();
+
+    const __int128 p1  = NTT_PRIME_1;
+    const __int128 p12 = p1 * NTT_PRIME_2;
+    const __int128 m   = p12 * NTT_PRIME_3;
+
+    // x = x1 + p1 * t2 + p1 * p2 * t3, each digit below its prime
+    const uint32_t t2 = ((M2(x2) - M2(x1)) * p1_inv).value();
+    const uint32_t t3 = ((M3(x3) - M3(x1) - M3(int64_t(p1 * t2 % NTT_PRIME_3))) * p12_inv).value();
+
+    __int128 x = x1 + p1 * t2 + p12 * t3;
+    if (x > m / 2)
+        x -= m;
+    return x;
+}
+
+/*
+ * Linear convolution of integer sequences by the NTTs of the three primes
+ * and crt_combine: add(i, x) is called with the coeficients x of the
+ * product, exact while they are below 2^85 in absolute value. Operands
+ * whose product exceeds max_size points are cut into chunks of max_size / 2
+ * and add() gets the chunk products, so that it is called several times for
+ * the same i.
+ */
+template<typename Int, typename Add>
+void crt_convolution(std::vector<Int> const & a, std::vector<Int> const & b, Add add,
+                     size_t max_size = CRT_CONVOLUTION_MAX);
+
+/*
+ * Linear convolution of a and b (size a.size() + b.size() - 1) over Z/PZ.
+ * When P - 1 has no power of 2 large enough for the transform (any prime
+ * that is not NTT friendly, such as 10^9 + 7), the residues are multiplied
+ * exactly by crt_convolution and reduced modulo P.
+ */
+template<uint32_t P, typename T>
+std::vector<ModInt<P>> ntt_convolution(std::vector<T> const & a, std::vector<T> const & b)
+{
+    if (a.empty() || b.empty())
+        return {};
+
+    const size_t result_size = a.size() + b.size() - 1;
+
+    size_t n = 1;
+    while (n < result_size)
+        n <<= 1;
+
+    if ((P - 1) % n != 0)
+    {
+        auto residues = [] (std::vector<T> const & v)
+        {
+            std::vector<int64_t> r(v.size());
+            for (size_t i = 0; i < v.size(); ++i)
+                r[i] = ModInt<P>(v[i]).value();
+            return r;
+        };
+
+        // residues below 2^30: products below 2^60 * CRT_CONVOLUTION_MAX / 2, exact
+        std::vector<ModInt<P>> result(result_size);
+        crt_convolution(residues(a), residues(b), [&] (size_t i, __int128 x)
+        {
+            result[i] += ModInt<P>(int64_t(x % P));
+        });
+        return result;
+    }
+
+    ModInt<P> * fa = ntt_workspace<P>(0, n);
+    ModInt<P> * fb = ntt_workspace<P>(1, n);
+
+    std::fill(std::copy(a.begin(), a.end(), fa), fa + n, ModInt<P>());
+    std::fill(std::copy(b.begin(), b.end(), fb), fb + n, ModInt<P>());
+
+    NTTPlan<P>::get(n).convolve(fa, fb);
+
+    return std::vector<ModInt<P>>(fa, fa + result_size);
+}
+
+// add(offset + i, x) for the coeficients of a single three prime product
+template<typename Int, typename Add>
+void crt_chunk_convolution(std::vector<Int> const & a, std::vector<Int> const & b, size_t offset, Add & add)
+{
+    const std::vector<ModInt<NTT_PRIME_1>> r1 = ntt_convolution<NTT_PRIME_1>(a, b);
+    const std::vector<ModInt<NTT_PRIME_2>> r2 = ntt_convolution<NTT_PRIME_2>(a, b);
+    const std::vector<ModInt<NTT_PRIME_3>> r3 = ntt_convolution<NTT_PRIME_3>(a, b);
+
+    for (size_t i = 0; i < r1.size(); ++i)
+        add(offset + i, crt_combine(r1[i].value(), r2[i].value(), r3[i].value()));
+}
+
+template<typename Int, typename Add>
+void crt_convolution(std::vector<Int> const & a, std::vector<Int> const & b, Add add, size_t max_size)
+{
+    if (a.empty() || b.empty())
+        return;
+
+    if (a.size() + b.size() - 1 <= max_size)
+    {
+        crt_chunk_convolution(a, b, 0, add);
+        return;
+    }
+
+    // chunk products have at most max_size - 1 coeficients
+    const size_t chunk = max_size / 2;
+    for (size_t i = 0; i < a.size(); i += chunk)
+    {
+        const std::vector<Int> a_i(a.begin() + i, a.begin() + std::min(i + chunk, a.size()));
+        for (size_t j = 0; j < b.size(); j += chunk)
+        {
+            const std::vector<Int> b_j(b.begin() + j, b.begin() + std::min(j + chunk, b.size()));
+            crt_chunk_convolution(a_i, b_j, i + j, add);
+        }
+    }
+}
+
+/*
+ * Exact linear convolution of integer sequences (see crt_convolution):
+ * exact as long as every output coeficient fits in Int, whatever the length
+ */
+template<typename Int>
+std::vector<Int> exact_convolution(std::vector<Int> const & a, std::vector<Int> const & b)
+{
+    static_assert(std::is_integral<Int>::value, "exact_convolution needs integer coefficients");
+
+    if (a.empty() || b.empty())
+        return {};
+
+    // chunk products are added modulo 2^bits, the final sums are the exact ones
+    using Unsigned = typename std::make_unsigned<Int>::type;
+
+    std::vector<Unsigned> sum(a.size() + b.size() - 1, 0);
+    crt_convolution(a, b, [&] (size_t i, __int128 x) { sum[i] += Unsigned(x); });
+
+    return std::vector<Int>(sum.begin(), sum.end());
+}
+
+#endif
@@ -0,0 +1,436 @@
+#include "OutOfCore.h"
+#include "NTT.h"
+
+#include <array>
+#include <fstream>
+#include <future>
+#include <vector>
+#include <stdexcept>
+#include <system_error>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+const size_t OutOfCoreMultiplier::DEFAULT_MEMORY_BUDGET;
+const size_t OutOfCoreMultiplier::LIMB_DIGITS;
+const size_t OutOfCoreMultiplier::POINT_BYTES;
+const size_t OutOfCoreMultiplier::ROW_BYTES_PER_POINT;
+const size_t OutOfCoreMultiplier::MIN_ROW_SIZE;
+const size_t OutOfCoreMultiplier::MAX_ROW_SIZE;
+
+OutOfCoreMultiplier::OutOfCoreMultiplier(size_t memory_budget)
+    : m_memory_budget(memory_budget)
+{}
+
+size_t OutOfCoreMultiplier::rowSize() const
+{
+    size_t row = MIN_ROW_SIZE;
+    while (row < MAX_ROW_SIZE && 2 * row * ROW_BYTES_PER_POINT <= m_memory_budget)
+    {
+        row <<= 1;
+    }
+    return row;
+}
+
+namespace
+{
+    const size_t LIMB_DIGITS = OutOfCoreMultiplier::LIMB_DIGITS;
+    const size_t POINT_BYTES = OutOfCoreMultiplier::POINT_BYTES;
+
+    const int64_t LIMB_BASE = 10000;
+    static_assert(LIMB_DIGITS == 4, "LIMB_BASE is 10^LIMB_DIGITS");
+
+    // Montgomery forms of the residues modulo the three primes
+    using Point = std::array<uint32_t, 3>;
+    static_assert(sizeof(Point) == OutOfCoreMultiplier::POINT_BYTES, "points are stored as they are");
+
+    constexpr uint32_t PRIMES[3] = { NTT_PRIME_1, NTT_PRIME_2, NTT_PRIME_3 };
+
+    // f(std::integral_constant<size_t, q>()) for the index q of each prime
+    template<typename F>
+    void for_each_prime(F f)
+    {
+        f(std::integral_constant<size_t, 0>());
+        f(std::integral_constant<size_t, 1>());
+        f(std::integral_constant<size_t, 2>());
+    }
+
+    /*
+     * Rows of transform points in a file that only lives as long as the
+     * object: it is unlinked as soon as it is created
+     */
+    class ScratchFile
+    {
+    public:
+        ScratchFile(std::string const & path, size_t row_size)
+            : m_row_bytes(row_size * POINT_BYTES)
+        {
+            m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+            if (m_fd < 0)
+                throw std::system_error(errno, std::generic_category(), "Cannot create " + path);
+
+            unlink(path.c_str());
+        }
+
+        ~ScratchFile() { close(m_fd); }
+
+        ScratchFile(ScratchFile const &) = delete;
+        ScratchFile & operator=(ScratchFile const &) = delete;
+
+        // count points of row from column first
+        void read(size_t row, size_t first, Point * points, size_t count) const
+        {
+            char * data = reinterpret_cast<char *>(points);
+            size_t len = count * POINT_BYTES;
+            off_t offset = row * m_row_bytes + first * POINT_BYTES;
+
+            while (len > 0)
+            {
+                const ssize_t r = pread(m_fd, data, len, offset);
+                if (r <= 0)
+                    throw std::runtime_error("Cannot read an out-of-core scratch file");
+
+                data += r;
+                len -= r;
+                offset += r;
+            }
+        }
+
+        void write(size_t row, size_t first, const Point * points, size_t count)
+        {
+            const char * data = reinterpret_cast<const char *>(points);
+            size_t len = count * POINT_BYTES;
+            off_t offset = row * m_row_bytes + first * POINT_BYTES;
+
+            while (len > 0)
+            {
+                const ssize_t w = pwrite(m_fd, data, len, offset);
+                if (w <= 0)
+                    throw std::runtime_error("Cannot write an out-of-core scratch file");
+
+                data += w;
+                len -= w;
+                offset += w;
+            }
+        }
+
+    private:
+        int    m_fd;
+        size_t m_row_bytes;
+    };
+
+    /*
+     * Limbs [first, first + count) of v, LIMB_DIGITS digits each. Reading
+     * faults the mapped pages in, which is what the read-ahead thread is for.
+     */
+    std::vector<uint32_t> load_limbs(LongMath::View const & v, size_t first, size_t count)
+    {
+        const size_t limbs = (v.size + LIMB_DIGITS - 1) / LIMB_DIGITS;
+        const size_t end = std::min(first + count, limbs);
+
+        std::vector<uint32_t> res(end - first, 0);
+        for (size_t l = first; l < end; ++l)
+        {
+            const size_t begin = l * LIMB_DIGITS;
+            for (size_t d = std::min(begin + LIMB_DIGITS, v.size); d-- > begin; )
+            {
+                res[l - first] = res[l - first] * 10 + v.digits[d];
+            }
+        }
+        return res;
+    }
+
+    /*
+     * Pass 1: the blocks of v transformed along x, one row each
+     */
+    void transform_rows(LongMath::View const & v, size_t block, size_t rows, size_t row_size, ScratchFile & file)
+    {
+        auto load = [&](size_t r) { return load_limbs(v, r * block, block); };
+
+        std::vector<Point> row(row_size);
+        std::future<std::vector<uint32_t>> next = std::async(std::launch::async, load, 0);
+
+        for (size_t r = 0; r < rows; ++r)
+        {
+            const std::vector<uint32_t> limbs = next.get();
+            if (r + 1 < rows)
+            {
+                next = std::async(std::launch::async, load, r + 1);
+            }
+
+            for_each_prime([&](auto q)
+            {
+                constexpr uint32_t P = PRIMES[decltype(q)::value];
+                ModInt<P> * x = ntt_workspace<P>(0, row_size);
+
+                std::fill(std::copy(limbs.begin(), limbs.end(), x), x + row_size, ModInt<P>());
+                NTTPlan<P>::get(row_size).forward(x);
+
+                for (size_t t = 0; t < row_size; ++t)
+                {
+                    row[t][q] = x[t].montgomery();
+                }
+            });
+
+            file.write(r, 0, row.data(), row_size);
+        }
+    }
+
+    struct Panel
+    {
+        std::vector<Point> left;
+        std::vector<Point> right;
+    };
+
+    /*
+     * Sequential writer of the result digits, the header is patched once the
+     * length is known
+     */
+    class ResultWriter
+    {
+    public:
+        explicit ResultWriter(std::string const & path)
+            : m_path(path)
+            , m_file(path, std::ios::binary | std::ios::trunc)
+            , m_written(0)
+            , m_significant(0)
+        {
+            if (!m_file)
+                throw std::runtime_error("Cannot open " + path);
+
+            unsigned char header[LONG_MATH_HEADER_SIZE] = {};
+            m_file.write(reinterpret_cast<const char *>(header), LONG_MATH_HEADER_SIZE);
+        }
+
+        void write(std::vector<char> const & digits)
+        {
+            m_file.write(digits.data(), digits.size());
+
+            for (size_t i = digits.size(); i > 0; --i)
+            {
+                if (digits[i - 1] != 0)
+                {
+                    m_significant = m_written + i;
+                    break;
+                }
+            }
+            m_written += digits.size();
+        }
+
+        void finish(LongMath::Sign sign)
+        {
+            // a zero product is positive
+            if (m_significant == 0)
+                sign = LongMath::Sign::POS;
+
+            unsigned char header[LONG_MATH_HEADER_SIZE];
+            encode_header(header, sign, m_significant);
+
+            m_file.seekp(0);
+            m_file.write(reinterpret_cast<const char *>(header), LONG_MATH_HEADER_SIZE);
+            m_file.close();
+
+            if (!m_file)
+                throw std::runtime_error("Failed to write " + m_path);
+
+            // drop the leading zeros of the product
+            std::filesystem::resize_file(m_path, LONG_MATH_HEADER_SIZE + m_significant);
+        }
+
+    private:
+        std::string   m_path;
+        std::ofstream m_file;
+        size_t        m_written;
+        size_t        m_significant;
+    };
+}
+
+void OutOfCoreMultiplier::multiply( std::string const & left_path
+                                  , std::string const & right_path
+                                  , std::string const & result_path) const
+{
+    MappedLongMath left(left_path), right(right_path);
+    const LongMath::View a = left.view(), b = right.view();
+
+    const LongMath::Sign sign = (a.isNegative() != b.isNegative()) ? LongMath::Sign::NEG : LongMath::Sign::POS;
+    ResultWriter writer(result_path);
+
+    if (a.size == 0 || b.size == 0)
+    {
+        writer.finish(sign);
+        return;
+    }
+
+    const size_t limbs_a = (a.size + LIMB_DIGITS - 1) / LIMB_DIGITS;
+    const size_t limbs_b = (b.size + LIMB_DIGITS - 1) / LIMB_DIGITS;
+
+    // no longer rows than a single one holding the whole product
+    size_t row_size = 2;
+    while (row_size < rowSize() && row_size < limbs_a + limbs_b)
+    {
+        row_size <<= 1;
+    }
+
+    const size_t block = row_size / 2;
+    const size_t rows_a = (limbs_a + block - 1) / block;
+    const size_t rows_b = (limbs_b + block - 1) / block;
+    const size_t rows_c = rows_a + rows_b - 1;
+
+    size_t column_size = 1;
+    while (column_size < rows_c)
+    {
+        column_size <<= 1;
+    }
+    if (column_size > MAX_ROW_SIZE)
+        throw std::length_error("Operands too large for out-of-core multiplication");
+
+    ScratchFile file_a(result_path + ".a.tmp", row_size);
+    ScratchFile file_b(result_path + ".b.tmp", row_size);
+    ScratchFile file_c(result_path + ".c.tmp", row_size);
+
+    // Pass 1
+    transform_rows(a, block, rows_a, row_size, file_a);
+    transform_rows(b, block, rows_b, row_size, file_b);
+
+    // Pass 2: panels of both operands, the next ones read ahead, and the product one
+    const size_t width = std::min(row_size, std::max<size_t>(1, m_memory_budget / (3 * column_size * POINT_BYTES)));
+
+    auto load_panel = [&](size_t first)
+    {
+        const size_t w = std::min(width, row_size - first);
+
+        Panel p{ std::vector<Point>(rows_a * w), std::vector<Point>(rows_b * w) };
+        for (size_t r = 0; r < rows_a; ++r)
+        {
+            file_a.read(r, first, &p.left[r * w], w);
+        }
+        for (size_t r = 0; r < rows_b; ++r)
+        {
+            file_b.read(r, first, &p.right[r * w], w);
+        }
+        return p;
+    };
+
+    std::vector<Point> product(rows_c * width);
+    std::future<Panel> next_panel = std::async(std::launch::async, load_panel, 0);
+
+    for (size_t first = 0; first < row_size; first += width)
+    {
+        const Panel panel = next_panel.get();
+        if (first + width < row_size)
+        {
+            next_panel = std::async(std::launch::async, load_panel, first + width);
+        }
+
+        const size_t w = std::min(width, row_size - first);
+        for (size_t c = 0; c < w; ++c)
+        {
+            for_each_prime([&](auto q)
+            {
+                constexpr uint32_t P = PRIMES[decltype(q)::value];
+                using Mod = ModInt<P>;
+
+                Mod * x = ntt_workspace<P>(0, column_size);
+                Mod * y = ntt_workspace<P>(1, column_size);
+
+                for (size_t r = 0; r < column_size; ++r)
+                {
+                    x[r] = (r < rows_a) ? Mod::fromMontgomery(panel.left[r * w + c][q])  : Mod();
+                    y[r] = (r < rows_b) ? Mod::fromMontgomery(panel.right[r * w + c][q]) : Mod();
+                }
+
+                NTTPlan<P>::get(column_size).convolve(x, y);
+
+                for (size_t r = 0; r < rows_c; ++r)
+                {
+                    product[r * w + c][q] = x[r].montgomery();
+                }
+            });
+        }
+
+        for (size_t r = 0; r < rows_c; ++r)
+        {
+            file_c.write(r, first, &product[r * w], w);
+        }
+    }
+
+    // Pass 3: product row k starts at limb k * block, its second half overlaps row k + 1
+    auto load_row = [&](size_t k)
+    {
+        std::vector<Point> row(row_size);
+        file_c.read(k, 0, row.data(), row_size);
+        return row;
+    };
+
+    std::vector<__int128> window(row_size, 0);
+    std::vector<char> digits(block * LIMB_DIGITS);
+    __int128 carry = 0;
+
+    auto flush_block = [&]()
+    {
+        for (size_t t = 0; t < block; ++t)
+        {
+            carry += window[t];
+            int64_t limb = int64_t(carry % LIMB_BASE);
+            carry /= LIMB_BASE;
+
+            for (size_t d = 0; d < LIMB_DIGITS; ++d, limb /= 10)
+            {
+                digits[t * LIMB_DIGITS + d] = limb % 10;
+            }
+        }
+        writer.write(digits);
+
+        std::copy(window.begin() + block, window.end(), window.begin());
+        std::fill(window.begin() + block, window.end(), 0);
+    };
+
+    std::future<std::vector<Point>> next_row = std::async(std::launch::async, load_row, 0);
+
+    for (size_t k = 0; k < rows_c; ++k)
+    {
+        const std::vector<Point> row = next_row.get();
+        if (k + 1 < rows_c)
+        {
+            next_row = std::async(std::launch::async, load_row, k + 1);
+        }
+
+        for_each_prime([&](auto q)
+        {
+            constexpr uint32_t P = PRIMES[decltype(q)::value];
+            ModInt<P> * x = ntt_workspace<P>(0, row_size);
+
+            for (size_t t = 0; t < row_size; ++t)
+            {
+                x[t] = ModInt<P>::fromMontgomery(row[t][q]);
+            }
+            NTTPlan<P>::get(row_size).inverse(x);
+        });
+
+        const ModInt<PRIMES[0]> * x1 = ntt_workspace<PRIMES[0]>(0, row_size);
+        const ModInt<PRIMES[1]> * x2 = ntt_workspace<PRIMES[1]>(0, row_size);
+        const ModInt<PRIMES[2]> * x3 = ntt_workspace<PRIMES[2]>(0, row_size);
+
+        for (size_t t = 0; t < row_size; ++t)
+        {
+            window[t] += crt_combine(x1[t].value(), x2[t].value(), x3[t].value());
+        }
+
+        flush_block();
+    }
+
+    flush_block();
+
+    while (carry != 0)
+    {
+        std::vector<char> tail;
+        for (; carry != 0; carry /= 10)
+        {
+            tail.push_back(char(carry % 10));
+        }
+        writer.write(tail);
+    }
+
+    writer.finish(sign);
+}
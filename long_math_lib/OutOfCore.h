@@ -0,0 +1,89 @@
+#ifndef _OUT_OF_CORE_H_
+#define _OUT_OF_CORE_H_
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#include "LongMathIO.h"
+
+/*
+ * Multiplies operands stored on disk in the DIGITS LongMath binary format
+ * (see LongMathIO.h, they are memory-mapped) whose size, together with the
+ * transform buffers, exceeds the available memory.
+ *
+ * The digits are packed LIMB_DIGITS to a limb and both operands are cut
+ * into blocks of blockSize() digits: A = sum A_i y^i with y = 10^blockSize().
+ * The product is a two dimensional convolution, along the limbs of the
+ * blocks (x) and along the blocks (y), computed by number theoretic
+ * transforms modulo the three NTT primes in three passes over scratch
+ * files:
+ *
+ *     1. rows: each block is read, transformed along x (rowSize() points,
+ *        twice the block) and written as a row of a scratch file
+ *     2. columns: panels of a few columns of all the rows of both operands
+ *        are read, transformed along y, multiplied pointwise, transformed
+ *        back and written as the rows of the product
+ *     3. rows again: each product row is transformed back along x, its
+ *        residues combined by CRT and the overlapping rows added and
+ *        carried, so the result is written sequentially
+ *
+ * The work is O(N log N) like an in-memory transform, and every pass reads
+ * the next row or panel ahead asynchronously while the current one is
+ * transformed.
+ *
+ * The row size is derived from the memory budget, which bounds the memory
+ * held at any time: ROW_BYTES_PER_POINT for the row passes and the panels
+ * of the column pass are as wide as the budget allows. Memory only exceeds
+ * the budget when even a single column does not fit, for operands of the
+ * order of budget^2 / 10^4 limbs.
+ */
+class OutOfCoreMultiplier
+{
+public:
+    static const size_t DEFAULT_MEMORY_BUDGET = size_t(1) << 30;
+
+    // Decimal digits per transform point, products stay far below the 2^85 of the CRT
+    static const size_t LIMB_DIGITS = 4;
+
+    // A transform point: its residues modulo the three NTT primes
+    static const size_t POINT_BYTES = 3 * sizeof(uint32_t);
+
+    /*
+     * Memory per point of a row in the last pass, the largest of the row
+     * passes: the row, the next one read ahead, the transform buffers of
+     * the three primes and the 128-bit carry window
+     */
+    static const size_t ROW_BYTES_PER_POINT = 3 * POINT_BYTES + sizeof(__int128);
+
+    static const size_t MIN_ROW_SIZE = 64;
+
+    // Longest NTT_PRIME_1 transform (see NTT.h), along rows and columns
+    static const size_t MAX_ROW_SIZE = size_t(1) << 23;
+
+    explicit OutOfCoreMultiplier(size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+
+    void   setMemoryBudget(size_t memory_budget) { m_memory_budget = memory_budget; }
+    size_t getMemoryBudget() const               { return m_memory_budget; }
+
+    // Transform points per row for the current memory budget, a power of 2
+    size_t rowSize() const;
+
+    // Number of digits per block, half a row of limbs
+    size_t blockSize() const { return rowSize() / 2 * LIMB_DIGITS; }
+
+    /*
+     * result_path = left_path * right_path, all three in the DIGITS format.
+     * The result file is overwritten; the scratch files are created next to
+     * it and removed. Throws std::length_error when the product needs
+     * columns longer than MAX_ROW_SIZE.
+     */
+    void multiply( std::string const & left_path
+                 , std::string const & right_path
+                 , std::string const & result_path) const;
+
+private:
+    size_t m_memory_budget;
+};
+
+#endif
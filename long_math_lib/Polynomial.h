@@ -1,43 +1,19 @@
 #ifndef _POLYNOMIAL_H_
 #define _POLYNOMIAL_H_
 
-#include <complex>
 #include <vector>
 #include <initializer_list>
 #include <algorithm>
+#include <iterator>
 #include <bitset>
 #include <stdexcept>
+#include <type_traits>
+#include <cmath>
 
-static const unsigned char BitReverseTable256[] = 
-{
-  0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0, 
-  0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8, 
-  0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4, 
-  0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC, 
-  0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2, 0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2, 
-  0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
-  0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6, 
-  0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE, 0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
-  0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
-  0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9, 
-  0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5, 0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
-  0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
-  0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3, 
-  0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB, 0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
-  0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7, 
-  0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF
-};
-
-inline uint32_t bit_reverse(uint32_t i, uint8_t n)
-{
-    uint32_t c =    (BitReverseTable256[ i        & 0xff] << 24) | 
-                    (BitReverseTable256[(i >> 8)  & 0xff] << 16) | 
-                    (BitReverseTable256[(i >> 16) & 0xff] << 8 ) |
-                    (BitReverseTable256[(i >> 24) & 0xff]);
-
-    c >>= 32 - n;
-    return c;
-}
+#include "FFT.h"
+#include "ScalarFFT.h"
+#include "NTT.h"
+#include "Kronecker.h"
 
 /*
  *
@@ -48,8 +24,6 @@ class Polynomial
 public:
     using CoefVector    = std::vector<CoefType>;
     using CoefVectorIt  = typename CoefVector::const_iterator;
-    using Complex       = std::complex<double>;
-    using ComplexVector = std::vector<Complex>;
     //to be compatible with std containers
     using value_type    = CoefType;
 
@@ -73,16 +47,21 @@ public:
     }
 
     Polynomial(Polynomial && p)
+        : m_coef(std::move(p.m_coef))
     {
-        m_coef = p.m_coef;
         p.m_coef.clear();
     }
 
     template<typename T>
     void assign(std::vector<T> const & coefs)
     {
-        m_coef.clear();
-        std::copy(coefs.begin(), coefs.end(), std::back_inserter(m_coef));
+        assign(coefs.begin(), coefs.end());
+    }
+
+    template<typename It>
+    void assign(It begin, It end)
+    {
+        m_coef.assign(begin, end);
     }
 
     size_t size() const   { return m_coef.size(); }
@@ -90,16 +69,93 @@ public:
     
     CoefType  const & operator[](size_t index) const { return m_coef.at(index); } 
 
+    CoefVector const & coefs() const { return m_coef; }
+
     // Multiply by -1
     void negate()
     {
         std::for_each(m_coef.begin(), m_coef.end(), [] (CoefType & c) { c=-c; } );
     }
 
+    /*
+     * Value at x by Horner's method
+     */
     template<typename T>
     T operator()(T const & x) const
     {
-        return compute_recursive(x, m_coef.begin());
+        T res = T(0);
+        for (auto it = m_coef.rbegin(); it != m_coef.rend(); ++it)
+            res = res * x + T(*it);
+        return res;
+    }
+
+    /*
+     * Value at x by Estrin's scheme on blocks of 8 coeficients:
+     * (c0 + c1*x) + (c2 + c3*x)*x^2 + ((c4 + c5*x) + (c6 + c7*x)*x^2)*x^4,
+     * the blocks being combined by Horner's method in x^8. The products of
+     * a block are independent, so they fill the pipeline instead of
+     * Horner's single dependency chain. Rounding differs from Horner's.
+     */
+    template<typename T>
+    T estrin(T const & x) const
+    {
+        const T x2 = x * x;
+        const T x4 = x2 * x2;
+        const T x8 = x4 * x4;
+
+        // coeficient i, zero past the end for the top block
+        auto c = [this] (size_t i) { return (i < m_coef.size()) ? T(m_coef[i]) : T(0); };
+
+        T res = T(0);
+        for (size_t k = (m_coef.size() + 7) / 8; k-- > 0; )
+        {
+            const size_t i = 8 * k;
+            const T b01 = c(i)     + c(i + 1) * x;
+            const T b23 = c(i + 2) + c(i + 3) * x;
+            const T b45 = c(i + 4) + c(i + 5) * x;
+            const T b67 = c(i + 6) + c(i + 7) * x;
+
+            res = res * x8 + ((b01 + b23 * x2) + (b45 + b67 * x2) * x4);
+        }
+        return res;
+    }
+
+    /*
+     * Values at count points: out[i] = p(xs[i]). Horner's steps run over
+     * blocks of points, so that each step is a vectorized loop over
+     * independent points, and blocks are shared by the OpenMP threads
+     * for large batches.
+     */
+    template<typename T>
+    void evaluate(const T * xs, T * out, size_t count) const
+    {
+        const size_t BLOCK = 256;
+        const long long blocks = (count + BLOCK - 1) / BLOCK;
+
+        #pragma omp parallel for schedule(static) if (count * m_coef.size() >= (1 << 20))
+        for (long long b = 0; b < blocks; ++b)
+        {
+            const size_t first = b * BLOCK;
+            const size_t len   = std::min(BLOCK, count - first);
+            const T * __restrict__ x = xs + first;
+            T * __restrict__ res = out + first;
+
+            std::fill(res, res + len, T(0));
+            for (auto it = m_coef.rbegin(); it != m_coef.rend(); ++it)
+            {
+                const T c = T(*it);
+                for (size_t i = 0; i < len; ++i)
+                    res[i] = res[i] * x[i] + c;
+            }
+        }
+    }
+
+    template<typename T>
+    std::vector<T> evaluate(std::vector<T> const & xs) const
+    {
+        std::vector<T> out(xs.size());
+        evaluate(xs.data(), out.data(), xs.size());
+        return out;
     }
 
     void operator+=(const Polynomial & p)
@@ -141,11 +197,33 @@ public:
     void operator*=(const Polynomial & p)
     {
         /*
-         * If resulted polynomial size is less than 1500, the naive method performs better
-         * 1500 comes from the impirical measurements. See examples/poly_mult_perf
+         * Results of less than TRANSFORM_MIN coeficients (EXACT_TRANSFORM_MIN
+         * for the three prime NTT), or with an operand shorter than
+         * TRANSFORM_MIN_FACTOR, are faster by Karatsuba, with its schoolbook
+         * base case. From the measurements of examples/poly_mult_perf
          */
-        if (p.m_coef.size() + m_coef.size() - 1 < 1500 )
-            naive_multiplication(p);
+        const size_t result_size = p.m_coef.size() + m_coef.size() - 1;
+        const size_t shorter = std::min(p.m_coef.size(), m_coef.size());
+
+        if constexpr (std::is_same<CoefType, LongMath>::value)
+        {
+            // one big integer product instead of n^2 LongMath ones
+            kronecker_multiplication(p);
+        }
+        else if (result_size < TRANSFORM_MIN || shorter < TRANSFORM_MIN_FACTOR)
+            karatsuba_multiplication(p);
+        else if constexpr (is_mod_int<CoefType>::value)
+            NTT_multiplication(p);
+        else if constexpr (std::is_integral<CoefType>::value)
+        {
+            // the FFT rounds to the exact product while it stays small enough
+            if (result_bits(m_coef, p.m_coef) <= FFT_EXACT_BITS)
+                FFT_multiplication(p);
+            else if (result_size < EXACT_TRANSFORM_MIN)
+                karatsuba_multiplication(p);
+            else
+                NTT_multiplication(p);
+        }
         else
             FFT_multiplication(p);
     }
@@ -171,158 +249,913 @@ public:
     friend std::ostream & operator<<(std::ostream &, Polynomial<T> const &);
 
     /*
-     * Naive polynomial multiplication O(N^2)
+     * Schoolbook polynomial multiplication O(N^2), see schoolbook()
      */
     void naive_multiplication(const Polynomial<CoefType> & p)
     {
-        CoefVector tmp_coefs;
-    
-        size_t l_size = m_coef.size();
-        size_t r_size = p.m_coef.size();
-    
-        for(size_t i=0; i<l_size+r_size-1; ++i)
-        {  
-            double coef = 0;
-            
-            for (size_t j=0; j<i+1; ++j)
-            {
-                if (i-j<l_size && j<r_size)
-                {
-                    coef += m_coef[i-j] * p.m_coef[j];
-                }
-            }
-    
-            tmp_coefs.push_back(coef);
-        }
-    
-        m_coef.swap(tmp_coefs);
-    }    
+        // a zero factor gives zero coeficients, as many as the degrees add up to
+        CoefVector product(std::max<size_t>(m_coef.size() + p.m_coef.size(), 1) - 1, CoefType(0));
+        schoolbook(work(m_coef.data()), m_coef.size(), work(p.m_coef.data()), p.m_coef.size(),
+                   work(product.data()));
+        m_coef.swap(product);
+    }
+
+    /*
+     * Karatsuba multiplication O(N^1.58): three half size products instead
+     * of four, down to KARATSUBA_MIN coeficients. The longer operand is cut
+     * into pieces of the size of the shorter one.
+     */
+    void karatsuba_multiplication(const Polynomial<CoefType> & p)
+    {
+        CoefVector product(std::max<size_t>(m_coef.size() + p.m_coef.size(), 1) - 1, CoefType(0));
+        unbalanced_karatsuba(work(m_coef.data()), m_coef.size(), work(p.m_coef.data()), p.m_coef.size(),
+                             work(product.data()));
+        m_coef.swap(product);
+    }
 
     /*
      * Multiplication based on Fast Fourier transfomation O(N*log(N))
+     * Both factors are real, so they share one complex transform and the
+     * product comes back from a half size one (see FFTPlan::convolveReal).
+     * Runs in place in a per-thread workspace, using cached plans.
+     *
+     * Real is the scalar of the transform: double for FFTPlan, DoubleDouble
+     * for ScalarFFTPlan (see fft_precision to choose between them).
      */
+    template<typename Real = double>
     void FFT_multiplication(const Polynomial<CoefType> & p)
     {
-        size_t result_size = m_coef.size() + p.size();
-        
-        // Resize in order to have 2^k points 
-        size_t n = 1;
-        while (n < result_size)
-            n = n << 1;
- 
-        ComplexVector input1 = get_coef_as_complex();
-        ComplexVector input2 = p.get_coef_as_complex();
-        
-        input1.resize(n);
-        input2.resize(n);
+        static_assert(std::is_same<Real, double>::value || std::is_same<Real, DoubleDouble>::value,
+                      "FFT scalar must be double or DoubleDouble");
+
+        if constexpr (std::is_same<Real, double>::value)
+        {
+            if (m_coef.empty() || p.m_coef.empty())
+            {
+                m_coef.clear();
+                return;
+            }
+
+            size_t result_size = m_coef.size() + p.size();
+
+            // Pad to the cheapest transform size (2^k, or 3, 5, 7 * 2^k points)
+            const size_t n = FFTPlan::goodSize(result_size);
+
+            double * re = fft_workspace(0, n);
+            double * im = fft_workspace(1, n);
 
-        ComplexVector fft1 = FFT(input1);
-        ComplexVector fft2 = FFT(input2);
+            load_coefs(m_coef,   re, n);
+            load_coefs(p.m_coef, im, n);
 
-        // pointwse multiplication
-        for(auto i = 0u; i<n; ++i)
+            FFTPlan::get(n).convolveReal(re, im);
+
+            // cut off irrelevant coeficients
+            m_coef.resize(result_size - 1);
+            for (size_t i = 0; i < result_size - 1; ++i)
+            {
+                m_coef[i] = from_real((i % 2 == 0) ? re[i / 2] : im[i / 2]);
+            }
+        }
+        else
         {
-            fft1[i] *= fft2[i];
+            const std::vector<Real> product = fft_convolution<Real>(m_coef, p.m_coef);
+
+            m_coef.resize(product.size());
+            for (size_t i = 0; i < product.size(); ++i)
+                m_coef[i] = from_real(product[i]);
         }
-        
-        // inverse FFT
-        fft2 = FFT(fft1, true);
-        
-        m_coef.clear();
-        for(auto c : fft2)
+    }
+
+    /*
+     * Exact multiplication of integer or LongMath coeficients by Kronecker
+     * substitution: a single LongMath product (see Kronecker.h)
+     */
+    void kronecker_multiplication(const Polynomial<CoefType> & p)
+    {
+        m_coef = kronecker_product(m_coef, p.m_coef);
+    }
+
+    /*
+     * Exact multiplication by number theoretic transform O(N*log(N)):
+     * one NTT for ModInt coeficients, three NTTs and a CRT for integer ones
+     * and for primes P without the roots of unity (exact while the result
+     * coeficients fit in CoefType, see NTT.h)
+     */
+    void NTT_multiplication(const Polynomial<CoefType> & p)
+    {
+        if constexpr (is_mod_int<CoefType>::value)
         {
-            m_coef.push_back(c.real());
+            m_coef = ntt_convolution<CoefType::MOD>(m_coef, p.m_coef);
         }
+        else
+        {
+            static_assert(std::is_integral<CoefType>::value, "NTT multiplication needs integer or ModInt coeficients");
+            m_coef = exact_convolution(m_coef, p.m_coef);
+        }
+    }
+
+    /*
+     * Short product: the n lowest coeficients of *this * b, without the
+     * cost of the whole product. Where the whole product is Karatsuba it is
+     * Mulders' short product (about 0.8 of it); with transforms, a product
+     * wrapped around on about n points, its lowest coeficients corrected by
+     * a smaller short product, when the whole product would need a
+     * transform twice as large. Other sizes, integer coeficients in the
+     * transform range and LongMath ones take the whole product and drop its
+     * high coeficients.
+     */
+    Polynomial mullo(const Polynomial & b, size_t n) const
+    {
+        return Polynomial(product(m_coef, b.m_coef, n));
+    }
+
+    /*
+     * Power series inverse: q such that p * q = 1 mod x^n, by Newton
+     * iteration q <- q * (2 - p * q), which doubles the number of correct
+     * terms at each step, so it costs a few multiplications of size n.
+     * The constant coeficient must be invertible.
+     */
+    Polynomial inverse(size_t n) const
+    {
+        return Polynomial(inverse_series(m_coef, n));
+    }
+
+    /*
+     * Quotient and remainder by a nonzero b: *this = q * b + r with
+     * r.size() = deg(b). The reversed quotient is the reversed dividend
+     * times the inverse of the reversed b, so large divisions cost a few
+     * multiplications (see PolynomialModulus to reuse that inverse).
+     * Coeficients must form a field: floating point or ModInt.
+     */
+    void divmod(Polynomial const & b, Polynomial & q, Polynomial & r) const
+    {
+        const CoefVector divisor = trimmed(b.m_coef);
+        if (divisor.empty())
+            throw std::domain_error("polynomial division by zero");
+
+        const size_t m = divisor.size() - 1;
+        const size_t k = (m_coef.size() > m) ? m_coef.size() - m : 0;
+
+        CoefVector inv;
+        if (std::min(k, m) > LONG_DIVISION_MAX)
+            inv = inverse_series(CoefVector(divisor.rbegin(), divisor.rend()), k);
+
+        CoefVector quotient, remainder;
+        divide(m_coef, divisor, inv, &quotient, remainder);
+
+        q.m_coef.swap(quotient);
+        r.m_coef.swap(remainder);
+    }
 
-        // cut off irrelevant coeficients
-        m_coef.resize(result_size - 1);
+    Polynomial operator/ (const Polynomial & b) const
+    {
+        Polynomial q, r;
+        divmod(b, q, r);
+        return q;
+    }
+
+    Polynomial operator% (const Polynomial & b) const
+    {
+        Polynomial q, r;
+        divmod(b, q, r);
+        return r;
     }
 
+    void operator/=(const Polynomial & b) { Polynomial r; divmod(b, *this, r); }
+    void operator%=(const Polynomial & b) { Polynomial q; divmod(b, q, *this); }
+
 
 private:
-    
+    template<typename> friend class PolynomialModulus;
+    template<typename> friend class PowerSeries;
+    template<typename> friend class TransformedPolynomial;
+    template<typename> friend class StreamingConvolver;
+
     /*
-     * returns coeficients as a vector of complex numbers
+     * Below this quotient or divisor size, long division (quotient size times
+     * divisor size operations) is faster than the Newton inverse
      */
-    ComplexVector get_coef_as_complex() const
+    static const size_t LONG_DIVISION_MAX = 64;
+
+    static CoefType coef_inverse(CoefType const & c)
+    {
+        if (c == CoefType(0))
+            throw std::domain_error("coeficient not invertible");
+
+        if constexpr (is_mod_int<CoefType>::value)
+            return c.inverse();
+        else
+            return CoefType(1) / c;
+    }
+
+    // Without the zero coeficients of the highest degrees
+    static CoefVector trimmed(CoefVector v)
     {
-        ComplexVector v;
-        for(auto c : m_coef) 
-            v.push_back(Complex(c,0));
+        while (!v.empty() && v.back() == CoefType(0))
+            v.pop_back();
         return v;
     }
 
     /*
-     * Horner's recursive method for calculating polynomial
+     * Short product: the n lowest coeficients of a * b, computing as few of
+     * the higher ones as the multiplication tier allows (see mullo)
      */
-    template<typename T>
-    T compute_recursive(T const & x, CoefVectorIt it) const
+    static CoefVector product(CoefVector const & a, CoefVector const & b, size_t n)
     {
-	    if (it == m_coef.end())
-            return T(0);
-	    return *it + x * compute_recursive(x, ++it);
+        const size_t na = std::min(a.size(), n);
+        const size_t nb = std::min(b.size(), n);
+        if (na == 0 || nb == 0)
+            return {};
+
+        Polynomial pa, pb;
+        pa.assign(a.begin(), a.begin() + na);
+        pb.assign(b.begin(), b.begin() + nb);
+        CoefVector const & la = pa.m_coef;
+        CoefVector const & lb = pb.m_coef;
+
+        // the product has fewer coeficients than asked for
+        const size_t full_size = na + nb - 1;
+        const size_t size = std::min(n, full_size);
+
+        // the tier operator*= takes for the whole product
+        bool transform = (full_size >= TRANSFORM_MIN && std::min(na, nb) >= TRANSFORM_MIN_FACTOR);
+        if constexpr (std::is_same<CoefType, LongMath>::value)
+            transform = true;
+        else if constexpr (std::is_integral<CoefType>::value)
+            transform = transform && (result_bits(la, lb) <= FFT_EXACT_BITS || full_size >= EXACT_TRANSFORM_MIN);
+
+        // padding a short operand costs more than the high coeficients saved
+        if (!transform && 2 * std::min(na, nb) > size)
+        {
+            // Mulders' short product on operands padded to size coeficients
+            pa.m_coef.resize(size, CoefType(0));
+            pb.m_coef.resize(size, CoefType(0));
+
+            CoefVector c(size, CoefType(0));
+            std::vector<WorkType> scratch(short_karatsuba_scratch(size));
+            short_karatsuba(work(pa.m_coef.data()), work(pb.m_coef.data()), size, work(c.data()), scratch.data());
+            return c;
+        }
+
+        /*
+         * A product wrapped modulo x^m - 1 (m >= size, about half the
+         * transform of the whole product) leaves the size lowest coeficients
+         * exact but for the r = full_size - m lowest ones, which have the
+         * top ones added: those come from the short product of size r,
+         * worth it while r is at most m / 4.
+         */
+        const size_t m = wrap_size(size);
+        if (transform && size >= TRANSFORM_MIN && m != 0 && m < full_size && 4 * (full_size - m) <= m)
+        {
+            CoefVector c = wrapped_product(la, lb, size);
+
+            const size_t r = full_size - m;
+            const CoefVector low = product(la, lb, r);
+            std::copy(low.begin(), low.end(), c.begin());
+            std::fill(c.begin() + low.size(), c.begin() + r, CoefType(0));
+            return c;
+        }
+
+        pa *= pb;
+        pa.m_coef.resize(size);
+        return std::move(pa.m_coef);
     }
-    
+
     /*
-     * Horner's recursive method for calculating polynomial. 
-     * Specialization for complex numbers.
+     * Modulus x^m - 1 of wrapped_product for n coeficients: the size of its
+     * transform, a power of 2 for the NTT, FFTPlan::goodSize for floating
+     * point. 0 when it has no transform of that size (integer coeficients,
+     * primes without the roots of unity).
      */
-    template<typename T>
-    std::complex<T> compute_recursive (std::complex<T> const & x, CoefVectorIt it) const
+    static size_t wrap_size(size_t n)
+    {
+        if constexpr (is_mod_int<CoefType>::value)
+        {
+            size_t m = 1;
+            while (m < n)
+                m <<= 1;
+            return ((CoefType::MOD - 1) % m == 0) ? m : 0;
+        }
+        else if constexpr (std::is_floating_point<CoefType>::value)
+            return FFTPlan::goodSize(n);
+        else
+            return 0;
+    }
+
+    /*
+     * a * b mod x^m - 1 for m = wrap_size(n) >= n, cut to n coeficients, for
+     * operands of at most n coeficients: one transform of about n points
+     * where the whole product needs twice as many. Only the coeficients from
+     * a.size() + b.size() - 1 - m up are those of a * b, the lower ones have
+     * the higher ones of the product added (wrapped around), so it is for
+     * callers that know the low coeficients of the product or compute them
+     * apart. Below the transform sizes, or without a transform (m = 0), the
+     * product is folded modulo x^n - 1 instead.
+     */
+    static CoefVector wrapped_product(CoefVector const & a, CoefVector const & b, size_t n)
     {
-        if (it == m_coef.end())
-            return std::complex<T>(0, 0);
+        if (a.size() > n || b.size() > n)
+            throw std::invalid_argument("wrapped product operands longer than the result");
 
-        auto res = std::complex<T>(*it, 0);
-        res +=  x * compute_recursive(x, ++it);
-        return res;
+        const size_t m = wrap_size(n);
+        if (m != 0 && n >= TRANSFORM_MIN && std::min(a.size(), b.size()) >= TRANSFORM_MIN_FACTOR)
+        {
+            if constexpr (is_mod_int<CoefType>::value)
+            {
+                constexpr uint32_t P = CoefType::MOD;
+
+                CoefType * fa = ntt_workspace<P>(0, m);
+                CoefType * fb = ntt_workspace<P>(1, m);
+
+                std::fill(std::copy(a.begin(), a.end(), fa), fa + m, CoefType());
+                std::fill(std::copy(b.begin(), b.end(), fb), fb + m, CoefType());
+
+                NTTPlan<P>::get(m).convolve(fa, fb);
+                return CoefVector(fa, fa + n);
+            }
+            else if constexpr (std::is_floating_point<CoefType>::value)
+            {
+                double * re = fft_workspace(0, m);
+                double * im = fft_workspace(1, m);
+
+                load_coefs(a, re, m);
+                load_coefs(b, im, m);
+
+                FFTPlan::get(m).convolveReal(re, im);
+
+                CoefVector c(n);
+                for (size_t i = 0; i < n; ++i)
+                    c[i] = from_real((i % 2 == 0) ? re[i / 2] : im[i / 2]);
+                return c;
+            }
+        }
+
+        // the whole product, folded
+        Polynomial p(a);
+        p *= Polynomial(b);
+
+        CoefVector c(n, CoefType(0));
+        for (size_t i = 0; i < p.m_coef.size(); ++i)
+            c[i % n] += p.m_coef[i];
+        return c;
     }
 
-    ComplexVector FFT(ComplexVector const & input, bool inverse = false)
+    // 1 / f mod x^n by Newton iteration
+    static CoefVector inverse_series(CoefVector const & f, size_t n)
     {
-        size_t N = input.size();
-        ComplexVector A;
-        A.resize(N);
-   
-        size_t N_l = ceil(log2(N));
-        for (size_t i=0; i<N; ++i)
-            A[i] = input[bit_reverse(i,N_l)];
-        
-        for (size_t s=1; s<=log2(N); ++s)
+        if (n == 0)
+            return {};
+        if (f.empty())
+            throw std::domain_error("coeficient not invertible");
+
+        CoefVector g = { coef_inverse(f[0]) };
+
+        for (size_t len = 1; len < n; )
+        {
+            len = std::min(2 * len, n);
+
+            /*
+             * g * (2 - f * g) = g - x^h * g * e mod x^len, with f * g = 1 + x^h * e
+             * mod x^len for the h = g.size() known terms of g. The h lowest
+             * terms of f * g are known, so they may wrap around.
+             */
+            const size_t h = g.size();
+            const CoefVector fg = wrapped_product(
+                CoefVector(f.begin(), f.begin() + std::min(f.size(), len)), g, len);
+
+            const CoefVector ge = product(g, CoefVector(fg.begin() + h, fg.end()), len - h);
+
+            g.resize(len, CoefType(0));
+            for (size_t i = 0; i < ge.size(); ++i)
+                g[h + i] -= ge[i];
+        }
+        return g;
+    }
+
+    /*
+     * a = q * b + r for b with a nonzero leading coeficient. inv is the
+     * inverse of the reversed b to at least a.size() - deg(b) terms, or empty
+     * for long division. q may be null when only the remainder is needed.
+     */
+    static void divide(CoefVector const & a, CoefVector const & b, CoefVector const & inv,
+                       CoefVector * q, CoefVector & r)
+    {
+        const size_t m = b.size() - 1;
+
+        if (a.size() <= m)
+        {
+            r = a;
+            r.resize(m, CoefType(0));
+            if (q)
+                q->clear();
+            return;
+        }
+
+        const size_t k = a.size() - m;
+
+        if (inv.empty())
+        {
+            r = a;
+            CoefVector quotient(k);
+            const CoefType lead_inv = coef_inverse(b[m]);
+
+            for (size_t i = k; i-- > 0; )
+            {
+                const CoefType c = r[i + m] * lead_inv;
+                quotient[i] = c;
+                for (size_t j = 0; j <= m; ++j)
+                    r[i + j] -= c * b[j];
+            }
+            r.resize(m);
+            if (q)
+                q->swap(quotient);
+            return;
+        }
+
+        CoefVector quotient = product(CoefVector(a.rbegin(), a.rbegin() + k), inv, k);
+        quotient.resize(k, CoefType(0));
+        std::reverse(quotient.begin(), quotient.end());
+
+        const CoefVector qb = product(quotient, b, m);
+        r.assign(a.begin(), a.begin() + m);
+        for (size_t i = 0; i < m && i < qb.size(); ++i)
+            r[i] -= qb[i];
+
+        if (q)
+            q->swap(quotient);
+    }
+
+    /*
+     * Integer coeficients are multiplied as their unsigned counterparts:
+     * arithmetic modulo 2^64 has no overflow, Karatsuba's intermediate sums
+     * included, and gives the product exactly whenever it fits in CoefType
+     */
+    using WorkType = typename std::conditional<std::is_integral<CoefType>::value,
+                                               std::make_unsigned<CoefType>,
+                                               std::enable_if<true, CoefType>>::type::type;
+
+    static WorkType * work(CoefType * c) { return reinterpret_cast<WorkType *>(c); }
+    static const WorkType * work(const CoefType * c) { return reinterpret_cast<const WorkType *>(c); }
+
+    static constexpr size_t TRANSFORM_MIN        = 256;
+    static constexpr size_t EXACT_TRANSFORM_MIN  = 4096;
+    static constexpr size_t TRANSFORM_MIN_FACTOR = 64;
+
+    // Products with a shorter operand than this are left to schoolbook()
+    static constexpr size_t KARATSUBA_MIN = 32;
+
+    // Coeficients of b per pass of schoolbook(), which stay in L1 with their outputs
+    static constexpr size_t SCHOOLBOOK_BLOCK = 512;
+
+    /*
+     * out[i + j] += a[i] * b[j]. For each block of b, every a[i] is a
+     * multiply-add over contiguous coeficients, without branches, which
+     * the compiler vectorizes
+     */
+    static void schoolbook(const WorkType * a, size_t na, const WorkType * b, size_t nb, WorkType * out)
+    {
+        for (size_t first = 0; first < nb; first += SCHOOLBOOK_BLOCK)
         {
-            size_t m = 1 << s; 
+            const size_t len = std::min(SCHOOLBOOK_BLOCK, nb - first);
+            const WorkType * __restrict__ block = b + first;
 
-            double theta =  (inverse ? -1 : 1) * 2 * M_PI / m;
-            double sint,cost;
-            sincos(theta, &sint, &cost);
-            Complex omega_m = Complex(cost, sint);
-            
-            for (size_t k=0; k<N; k+=m)
+            for (size_t i = 0; i < na; ++i)
             {
-                Complex omega = 1;
-                for(size_t j=0; j<m/2; ++j)
-                {
-                    Complex t = omega * A[k+j+m/2];         
-                    Complex u = A[k+j];
-                    A[k+j]     = u + t;
-                    A[k+j+m/2] = u - t;
-                    omega *= omega_m;
-                }
+                const WorkType ai = a[i];
+                WorkType * __restrict__ res = out + i + first;
+
+                for (size_t j = 0; j < len; ++j)
+                    res[j] += ai * block[j];
             }
         }
+    }
 
-        if (inverse)
+    /*
+     * out[0, 2n-1) = a * b for operands of n coeficients, using scratch
+     * space of karatsuba_scratch(n). out must be zeroed: the half products
+     * are written into it and read back for the middle term, and
+     * out[2h-1] between them is never written.
+     */
+    static void karatsuba(const WorkType * a, const WorkType * b, size_t n, WorkType * out, WorkType * scratch)
+    {
+        if (n < KARATSUBA_MIN)
         {
-            std::for_each(A.begin(), A.end(), [&] (Complex & c) { c/=N; } );
+            schoolbook(a, n, b, n, out);
+            return;
         }
-        
-        return A;
+
+        // a = a0 + x^h a1, the high halves are the longer ones
+        const size_t h  = n / 2;
+        const size_t hh = n - h;
+
+        WorkType * sa  = scratch;
+        WorkType * sb  = sa + hh;
+        WorkType * mid = sb + hh;
+        WorkType * rest = mid + 2 * hh - 1;
+
+        for (size_t i = 0; i < hh; ++i)
+        {
+            sa[i] = a[h + i];
+            sb[i] = b[h + i];
+        }
+        for (size_t i = 0; i < h; ++i)
+        {
+            sa[i] += a[i];
+            sb[i] += b[i];
+        }
+        std::fill(mid, mid + 2 * hh - 1, WorkType(0));
+
+        // (a0 + a1)(b0 + b1), a0 b0 and a1 b1 at their places
+        karatsuba(sa, sb, hh, mid, rest);
+        karatsuba(a, b, h, out, rest);
+        karatsuba(a + h, b + h, hh, out + 2 * h, rest);
+
+        // middle term (a0 + a1)(b0 + b1) - a0 b0 - a1 b1
+        for (size_t i = 0; i < 2 * h - 1; ++i)
+            mid[i] -= out[i];
+        for (size_t i = 0; i < 2 * hh - 1; ++i)
+            mid[i] -= out[2 * h + i];
+        for (size_t i = 0; i < 2 * hh - 1; ++i)
+            out[h + i] += mid[i];
+    }
+
+    static size_t karatsuba_scratch(size_t n)
+    {
+        size_t size = 0;
+        for (; n >= KARATSUBA_MIN; n -= n / 2)
+            size += 4 * (n - n / 2);
+        return size;
+    }
+
+    // Size of the full product in a short product of n coeficients, about 0.7 n
+    static size_t short_split(size_t n)
+    {
+        return std::max(n - n / 2, n * 7 / 10);
+    }
+
+    /*
+     * out[0, n) += the n lowest coeficients of a * b for operands of n
+     * coeficients (Mulders' short product): the full Karatsuba product of
+     * the k = short_split(n) lowest coeficients, plus the short products of
+     * n - k coeficients for the terms with a coeficient of index k or more
+     * (the other index is then below n - k). With k about 0.7 n it costs
+     * about 0.8 of the full product. Uses short_karatsuba_scratch(n).
+     */
+    static void short_karatsuba(const WorkType * a, const WorkType * b, size_t n, WorkType * out, WorkType * scratch)
+    {
+        if (n < KARATSUBA_MIN)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                const WorkType ai = a[i];
+                WorkType * __restrict__ res = out + i;
+
+                for (size_t j = 0; j < n - i; ++j)
+                    res[j] += ai * b[j];
+            }
+            return;
+        }
+
+        const size_t k = short_split(n);
+
+        WorkType * full = scratch;
+        std::fill(full, full + 2 * k - 1, WorkType(0));
+        karatsuba(a, b, k, full, full + 2 * k - 1);
+
+        for (size_t i = 0; i < std::min(n, 2 * k - 1); ++i)
+            out[i] += full[i];
+
+        // the scratch space is free again for the short products
+        short_karatsuba(a + k, b, n - k, out + k, scratch);
+        short_karatsuba(a, b + k, n - k, out + k, scratch);
+    }
+
+    static size_t short_karatsuba_scratch(size_t n)
+    {
+        if (n < KARATSUBA_MIN)
+            return 0;
+
+        const size_t k = short_split(n);
+        return std::max(2 * k - 1 + karatsuba_scratch(k), short_karatsuba_scratch(n - k));
+    }
+
+    // out[0, na+nb-1) += a * b, by equal size Karatsuba products
+    static void unbalanced_karatsuba(const WorkType * a, size_t na, const WorkType * b, size_t nb, WorkType * out)
+    {
+        if (na < nb)
+        {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+
+        if (nb < KARATSUBA_MIN)
+        {
+            schoolbook(a, na, b, nb, out);
+            return;
+        }
+
+        std::vector<WorkType> scratch(karatsuba_scratch(nb) + 2 * nb - 1);
+        WorkType * piece = scratch.data() + karatsuba_scratch(nb);
+
+        size_t first = 0;
+        for (; first + nb <= na; first += nb)
+        {
+            std::fill(piece, piece + 2 * nb - 1, WorkType(0));
+            karatsuba(a + first, b, nb, piece, scratch.data());
+
+            for (size_t i = 0; i < 2 * nb - 1; ++i)
+                out[first + i] += piece[i];
+        }
+
+        if (first < na)
+            unbalanced_karatsuba(a + first, na - first, b, nb, out + first);
+    }
+
+    /*
+     * Integer products whose coeficients need at most this many bits come
+     * out of FFT_multiplication with rounding errors below 2^-8 (measured up
+     * to 2^20 points), about 5 times faster than the exact NTT
+     */
+    static const unsigned FFT_EXACT_BITS = 40;
+
+    /*
+     * Bound on the bit size of the coeficients of a * b:
+     * bits(max |a_i|) + bits(max |b_j|) + bits(number of terms of a sum)
+     */
+    static unsigned result_bits(CoefVector const & a, CoefVector const & b)
+    {
+        auto bits = [] (uint64_t v) { return unsigned(64 - __builtin_clzll(v | 1)); };
+        auto max_bits = [&bits] (CoefVector const & coefs)
+        {
+            uint64_t m = 0;
+            for (auto c : coefs)
+                m = std::max<uint64_t>(m, (c < 0) ? 0 - uint64_t(c) : uint64_t(c));
+            return bits(m);
+        };
+        return max_bits(a) + max_bits(b) + bits(std::min(a.size(), b.size()));
+    }
+
+    /*
+     * Writes coeficients as doubles, zero padded up to n
+     */
+    static void load_coefs(CoefVector const & coefs, double * out, size_t n)
+    {
+        size_t i = 0;
+        for (; i < coefs.size(); ++i)
+            out[i] = double(coefs[i]);
+        for (; i < n; ++i)
+            out[i] = 0;
+    }
+
+    /*
+     * Transform output back to a coeficient, rounded for integer types
+     */
+    template<typename Real>
+    static CoefType from_real(Real c)
+    {
+        using std::llround;
+
+        if constexpr (std::is_integral<CoefType>::value)
+            return static_cast<CoefType>(llround(c));
+        else
+            return static_cast<CoefType>(c);
     }
 
 private:
     CoefVector m_coef;
 };
 
+/*
+ * Reductions modulo a fixed polynomial: the inverse of the reversed divisor
+ * is computed once, so that each reduction costs two multiplications.
+ * Dividends longer than twice the divisor are reduced from the top, one
+ * divisor length at a time. Immutable once built, so it can be shared by
+ * threads.
+ */
+template<typename CoefType>
+class PolynomialModulus
+{
+public:
+    using Poly       = Polynomial<CoefType>;
+    using CoefVector = typename Poly::CoefVector;
+
+    explicit PolynomialModulus(Poly const & divisor)
+        : m_divisor(Poly::trimmed(divisor.coefs()))
+    {
+        if (m_divisor.empty())
+            throw std::domain_error("polynomial division by zero");
+
+        m_inverse = Poly::inverse_series(CoefVector(m_divisor.rbegin(), m_divisor.rend()),
+                                         std::max<size_t>(degree(), 1));
+    }
+
+    Poly divisor() const { return Poly(m_divisor); }
+
+    size_t degree() const { return m_divisor.size() - 1; }
+
+    // a mod divisor, degree() coeficients
+    Poly reduce(Poly const & a) const
+    {
+        return Poly(reduce(a.coefs()));
+    }
+
+    // a * b mod divisor
+    Poly multiply(Poly const & a, Poly const & b) const
+    {
+        return reduce(a * b);
+    }
+
+    CoefVector reduce(CoefVector r) const
+    {
+        const size_t m = degree();
+        const size_t step = m_inverse.size();
+
+        // the top m + step coeficients are replaced by their remainder
+        while (r.size() > m + step)
+        {
+            const size_t low = r.size() - (m + step);
+
+            CoefVector rem;
+            Poly::divide(CoefVector(r.begin() + low, r.end()), m_divisor, m_inverse, nullptr, rem);
+
+            r.resize(low);
+            r.insert(r.end(), rem.begin(), rem.end());
+        }
+
+        CoefVector rem;
+        Poly::divide(r, m_divisor, m_inverse, nullptr, rem);
+        return rem;
+    }
+
+private:
+    CoefVector m_divisor;
+    // 1 / reversed divisor mod x^max(degree, 1)
+    CoefVector m_inverse;
+};
+
+/*
+ * Forward transform of a fixed operand b, for multiplying it by many
+ * polynomials: each product then costs a forward and an inverse transform of
+ * real data (FFTPlan::forwardReal), two half size transforms instead of the
+ * three of FFT_multiplication.
+ *
+ * The transform size is chosen for factors of up to factor_size coeficients.
+ * Longer factors are cut into pieces of that size whose products are added
+ * up (overlap-add). Immutable once built, so it can be shared by threads.
+ * Rounding is that of FFT_multiplication, integer products are exact while
+ * they need at most FFT_EXACT_BITS bits.
+ */
+template<typename CoefType>
+class TransformedPolynomial
+{
+    static_assert(std::is_arithmetic<CoefType>::value, "TransformedPolynomial needs real coeficients");
+
+public:
+    using Poly       = Polynomial<CoefType>;
+    using CoefVector = typename Poly::CoefVector;
+
+    TransformedPolynomial(Poly const & b, size_t factor_size)
+        : m_size(b.size())
+    {
+        if (factor_size == 0)
+            throw std::invalid_argument("TransformedPolynomial needs a factor size");
+
+        const size_t n = FFTPlan::goodSize(factor_size + std::max<size_t>(m_size, 1) - 1);
+        m_plan = &FFTPlan::get(n);
+        m_factor = n - std::max<size_t>(m_size, 1) + 1;
+
+        m_re.resize(n / 2);
+        m_im.resize(n / 2);
+        load(b.coefs(), 0, b.size(), m_re.data(), m_im.data());
+        m_plan->forwardReal(m_re.data(), m_im.data());
+    }
+
+    // Number of coeficients of the fixed operand
+    size_t size() const { return m_size; }
+
+    // Longest factor multiplied by a single product
+    size_t factorSize() const { return m_factor; }
+
+    size_t transformSize() const { return m_plan->size(); }
+
+    // a * b
+    Poly multiply(Poly const & a) const
+    {
+        if (a.size() == 0 || m_size == 0)
+            return Poly();
+
+        const size_t h = transformSize() / 2;
+        double * re = fft_workspace(0, h);
+        double * im = fft_workspace(1, h);
+
+        std::vector<double> product(a.size() + m_size - 1, 0);
+
+        for (size_t first = 0; first < a.size(); first += m_factor)
+        {
+            const size_t len = std::min(m_factor, a.size() - first);
+
+            load(a.coefs(), first, len, re, im);
+            m_plan->forwardReal(re, im);
+            m_plan->multiplyReal(re, im, m_re.data(), m_im.data());
+            m_plan->inverseReal(re, im);
+
+            double * out = product.data() + first;
+            for (size_t i = 0; i < len + m_size - 1; ++i)
+                out[i] += (i % 2 == 0) ? re[i / 2] : im[i / 2];
+        }
+
+        CoefVector coefs(product.size());
+        for (size_t i = 0; i < product.size(); ++i)
+            coefs[i] = Poly::from_real(product[i]);
+        return Poly(coefs);
+    }
+
+private:
+    // coefs[first, first + len) packed for FFTPlan::forwardReal, zero padded
+    void load(CoefVector const & coefs, size_t first, size_t len, double * re, double * im) const
+    {
+        const size_t h = transformSize() / 2;
+        for (size_t m = 0; m < h; ++m)
+        {
+            re[m] = (2 * m     < len) ? double(coefs[first + 2 * m])     : 0;
+            im[m] = (2 * m + 1 < len) ? double(coefs[first + 2 * m + 1]) : 0;
+        }
+    }
+
+private:
+    size_t              m_size;
+    size_t              m_factor;
+    FFTPlan const *     m_plan;
+    // spectrum of the fixed operand, as left by forwardReal
+    std::vector<double> m_re;
+    std::vector<double> m_im;
+};
+
+/*
+ * Product of the polynomials in [first, last), 1 for an empty range.
+ *
+ * Factors are multiplied pairwise in a tree whose levels pair neighbours by
+ * size: the two smallest factors, then the next two, the largest one
+ * waiting for the next level when their number is odd. The operands of each
+ * product have about the same size, even for factors of very different
+ * sizes, and the cost stays O(M(n) log(count)) instead of the O(n^2) of a
+ * left to right fold. Each node is an operator*=, which picks the
+ * multiplication by size (Karatsuba, FFT, NTT...). The products of a level
+ * are independent and share the OpenMP threads once the level holds enough
+ * coeficients.
+ */
+template<typename It>
+Polynomial<typename std::iterator_traits<It>::value_type::value_type> polynomial_product(It first, It last)
+{
+    using Poly = Polynomial<typename std::iterator_traits<It>::value_type::value_type>;
+    using Coef = typename Poly::value_type;
+
+    // Coeficients in a level from which its products run in parallel
+    constexpr size_t PARALLEL_THRESHOLD = 1 << 12;
+
+    std::vector<Poly> factors(first, last);
+    if (factors.empty())
+        return Poly{ Coef(1) };
+
+    // indices of the factors still to multiply, the products stay in place
+    std::vector<size_t> level(factors.size());
+    for (size_t i = 0; i < level.size(); ++i)
+        level[i] = i;
+
+    while (level.size() > 1)
+    {
+        std::stable_sort(level.begin(), level.end(),
+                         [&] (size_t l, size_t r) { return factors[l].size() < factors[r].size(); });
+
+        const long long pairs = level.size() / 2;
+
+        size_t level_size = 0;
+        for (size_t i : level)
+            level_size += factors[i].size();
+
+        #pragma omp parallel for schedule(dynamic) if (pairs > 1 && level_size >= PARALLEL_THRESHOLD)
+        for (long long j = 0; j < pairs; ++j)
+        {
+            factors[level[2 * j]] *= factors[level[2 * j + 1]];
+            factors[level[2 * j + 1]].resize(0);
+        }
+
+        std::vector<size_t> next;
+        for (long long j = 0; j < pairs; ++j)
+            next.push_back(level[2 * j]);
+        if (level.size() % 2 != 0)
+            next.push_back(level.back());
+        level.swap(next);
+    }
+    return std::move(factors[level[0]]);
+}
+
+template<typename T>
+Polynomial<T> polynomial_product(std::vector<Polynomial<T>> const & factors)
+{
+    return polynomial_product(factors.begin(), factors.end());
+}
+
 template<typename T>
 std::ostream & operator<<(std::ostream & os, Polynomial<T> const & poli)
 {
@@ -330,15 +1163,25 @@ std::ostream & operator<<(std::ostream & os, Polynomial<T> const & poli)
     
     for(auto it = poli.m_coef.rbegin(); it!=poli.m_coef.rend(); ++it, --pow)
     {
-        if (*it == 0)
+        if (*it == T(0))
            continue;
 
-        if (*it > 0 && it != poli.m_coef.rbegin())
+        if constexpr (is_mod_int<T>::value)
         {
-            os << "+";
+            // residues have no sign
+            if (it != poli.m_coef.rbegin())
+                os << "+";
+            os << *it;
+        }
+        else
+        {
+            if (*it > 0 && it != poli.m_coef.rbegin())
+            {
+                os << "+";
+            }
+
+            os << (double)*it;
         }
-        
-        os << (double)*it;
         
         if (pow != 0)
         {
@@ -0,0 +1,215 @@
+#ifndef _POWER_SERIES_H_
+#define _POWER_SERIES_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <cmath>
+
+#include "Polynomial.h"
+
+/*
+ * Formal power series truncated to a fixed number of terms (its precision):
+ * the coeficients of x^0 ... x^(precision-1).
+ *
+ * Products are short products (Polynomial::mullo), which compute the
+ * coeficients below the precision only. reciprocal, log, exp and sqrt use Newton
+ * iteration, doubling the number of correct terms at each step, so each
+ * costs a constant number of multiplications of the full size.
+ *
+ * Coeficients must form a field of characteristic 0 or larger than the
+ * precision: floating point, or ModInt with a large prime.
+ */
+template<typename CoefType>
+class PowerSeries
+{
+public:
+    using Poly       = Polynomial<CoefType>;
+    using CoefVector = typename Poly::CoefVector;
+
+    PowerSeries(CoefVector coefs, size_t precision)
+        : m_coef(std::move(coefs))
+    {
+        m_coef.resize(precision, CoefType(0));
+    }
+
+    PowerSeries(Poly const & p, size_t precision)
+        : PowerSeries(p.coefs(), precision)
+    {}
+
+    size_t precision() const { return m_coef.size(); }
+
+    CoefType const & operator[](size_t index) const { return m_coef.at(index); }
+
+    CoefVector const & coefs() const { return m_coef; }
+
+    Poly polynomial() const { return Poly(m_coef); }
+
+    // Results have the precision of the less precise operand
+    PowerSeries operator+(PowerSeries const & s) const
+    {
+        PowerSeries r(m_coef, std::min(precision(), s.precision()));
+        for (size_t i = 0; i < r.precision(); ++i)
+            r.m_coef[i] += s.m_coef[i];
+        return r;
+    }
+
+    PowerSeries operator-(PowerSeries const & s) const
+    {
+        PowerSeries r(m_coef, std::min(precision(), s.precision()));
+        for (size_t i = 0; i < r.precision(); ++i)
+            r.m_coef[i] -= s.m_coef[i];
+        return r;
+    }
+
+    PowerSeries operator*(PowerSeries const & s) const
+    {
+        const size_t n = std::min(precision(), s.precision());
+        return PowerSeries(Poly::product(m_coef, s.m_coef, n), n);
+    }
+
+    bool operator==(PowerSeries const & s) const { return m_coef == s.m_coef; }
+    bool operator!=(PowerSeries const & s) const { return m_coef != s.m_coef; }
+
+    // 1 / s, the constant coeficient must be invertible
+    PowerSeries reciprocal() const
+    {
+        return PowerSeries(Poly::inverse_series(m_coef, precision()), precision());
+    }
+
+    PowerSeries derivative() const
+    {
+        CoefVector d(precision(), CoefType(0));
+        for (size_t i = 1; i < precision(); ++i)
+            d[i - 1] = m_coef[i] * CoefType(int64_t(i));
+        return PowerSeries(std::move(d), precision());
+    }
+
+    // Antiderivative with a zero constant, the top term is lost
+    PowerSeries integral() const
+    {
+        CoefVector s(precision(), CoefType(0));
+        for (size_t i = 1; i < precision(); ++i)
+            s[i] = m_coef[i - 1] * Poly::coef_inverse(CoefType(int64_t(i)));
+        return PowerSeries(std::move(s), precision());
+    }
+
+    // log(s) = integral of s' / s, for s(0) = 1
+    PowerSeries log() const
+    {
+        if (precision() == 0)
+            return *this;
+        if (m_coef[0] != CoefType(1))
+            throw std::domain_error("power series log needs a constant coeficient of 1");
+
+        return (derivative() * reciprocal()).integral();
+    }
+
+    // exp(s) for s(0) = 0, by Newton iteration g <- g * (1 - log(g) + s)
+    PowerSeries exp() const
+    {
+        if (precision() == 0)
+            return *this;
+        if (m_coef[0] != CoefType(0))
+            throw std::domain_error("power series exp needs a constant coeficient of 0");
+
+        PowerSeries g(CoefVector(1, CoefType(1)), 1);
+        for (size_t len = 1; len < precision(); )
+        {
+            len = std::min(2 * len, precision());
+
+            const PowerSeries g_len(g.m_coef, len);
+            PowerSeries t = PowerSeries(m_coef, len) - g_len.log();
+            t.m_coef[0] += CoefType(1);
+
+            g = g_len * t;
+        }
+        return g;
+    }
+
+    // sqrt(s) with s(0) = 1, by Newton iteration g <- (g + s / g) / 2
+    PowerSeries sqrt() const
+    {
+        if (precision() == 0)
+            return *this;
+        if (m_coef[0] != CoefType(1))
+            throw std::domain_error("power series sqrt needs a constant coeficient of 1");
+
+        const CoefType half = Poly::coef_inverse(CoefType(2));
+
+        PowerSeries g(CoefVector(1, CoefType(1)), 1);
+        for (size_t len = 1; len < precision(); )
+        {
+            len = std::min(2 * len, precision());
+
+            const PowerSeries g_len(g.m_coef, len);
+            g = g_len + PowerSeries(m_coef, len) * g_len.reciprocal();
+            for (auto & c : g.m_coef)
+                c *= half;
+        }
+        return g;
+    }
+
+    /*
+     * s(q) truncated to the precision, for a polynomial q of low degree.
+     * Series composition when q(0) = 0, otherwise s is taken as the
+     * polynomial of its precision() terms. Divide and conquer on s:
+     * s_low(q) + q^h * s_high(q), the powers q^h being shared by the calls.
+     */
+    PowerSeries compose(Poly const & q) const
+    {
+        if (precision() == 0)
+            return *this;
+
+        // q^(2^i), the zero polynomial as the constant 0
+        std::vector<CoefVector> powers = { q.size() ? q.coefs() : CoefVector(1, CoefType(0)) };
+        while ((size_t(1) << powers.size()) < precision())
+            powers.push_back(Poly::product(powers.back(), powers.back(), precision()));
+
+        return PowerSeries(composeRange(0, precision(), powers), precision());
+    }
+
+private:
+    // Below this many terms, compose runs Horner's method
+    static const size_t COMPOSE_HORNER = 16;
+
+    // sum of m_coef[first + i] * q^i, i < count (a power of 2 but at the end)
+    CoefVector composeRange(size_t first, size_t count, std::vector<CoefVector> const & powers) const
+    {
+        const size_t n = precision();
+        const size_t last = std::min(first + count, n);
+
+        if (count <= COMPOSE_HORNER)
+        {
+            CoefVector r = { m_coef[last - 1] };
+            for (size_t i = last - 1; i-- > first; )
+            {
+                r = Poly::product(r, powers[0], n);
+                r[0] += m_coef[i];
+            }
+            return r;
+        }
+
+        size_t level = 0;
+        while ((size_t(2) << level) < count)
+            ++level;
+        const size_t half = size_t(1) << level;
+
+        CoefVector low = composeRange(first, half, powers);
+        if (first + half >= last)
+            return low;
+
+        const CoefVector high = Poly::product(composeRange(first + half, count - half, powers), powers[level], n);
+
+        low.resize(std::max(low.size(), high.size()), CoefType(0));
+        for (size_t i = 0; i < high.size(); ++i)
+            low[i] += high[i];
+        return low;
+    }
+
+private:
+    CoefVector m_coef;
+};
+
+#endif
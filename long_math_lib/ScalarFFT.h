@@ -0,0 +1,304 @@
+#ifndef _SCALAR_FFT_H_
+#define _SCALAR_FFT_H_
+
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <cmath>
+
+#include "DoubleDouble.h"
+
+/*
+ * Transform of 2^k points over the complex numbers of double or DoubleDouble
+ * (about 106 bits). FFTPlan remains the fast double transform; this one
+ * trades its kernels for the choice of precision, the double instance is
+ * the reference for DoubleDouble.
+ *
+ * As NTTPlan, the forward transform goes from natural to bit reversed order
+ * and the inverse one back, so a convolution never permutes the data. The
+ * forward transform uses the e^(+2*pi*i/n) root, the inverse one includes
+ * the 1/n scaling. The roots are computed to the precision of the scalar.
+ */
+template<typename Real>
+class ScalarFFTPlan
+{
+    // a float plan of these plain kernels measured slower than FFTPlan
+    static_assert(std::is_same<Real, double>::value || std::is_same<Real, DoubleDouble>::value,
+                  "ScalarFFTPlan scalar must be double or DoubleDouble");
+
+public:
+    explicit ScalarFFTPlan(size_t n)
+        : m_size(n)
+    {
+        if (n == 0 || (n & (n - 1)) != 0)
+            throw std::invalid_argument("ScalarFFTPlan size must be a power of 2");
+
+        std::vector<Real> w_re, w_im;
+        unitRoots(n, w_re, w_im);
+
+        // [h + j] = w_2h^j = w_n^(j * n / 2h) for the butterflies of half size h
+        m_roots_re.resize(n);
+        m_roots_im.resize(n);
+        for (size_t h = 1; h < n; h <<= 1)
+        {
+            const size_t stride = n / (2 * h);
+            for (size_t j = 0; j < h; ++j)
+            {
+                m_roots_re[h + j] = w_re[j * stride];
+                m_roots_im[h + j] = w_im[j * stride];
+            }
+        }
+
+        m_inverse_size = Real(1) / Real(int64_t(n));
+    }
+
+    size_t size() const { return m_size; }
+
+    // Natural order in, bit reversed order out
+    void forward(Real * re, Real * im) const
+    {
+        for (size_t h = m_size / 2; h >= 1; h >>= 1)
+        {
+            const Real * w_re = m_roots_re.data() + h;
+            const Real * w_im = m_roots_im.data() + h;
+
+            // the two halves of a block never overlap
+            for (size_t i = 0; i < m_size; i += 2 * h)
+                forwardBlock(re + i, im + i, re + i + h, im + i + h, w_re, w_im, h);
+        }
+    }
+
+    // Bit reversed order in, natural order out, including the 1/n scaling
+    void inverse(Real * re, Real * im) const
+    {
+        for (size_t h = 1; h < m_size; h <<= 1)
+        {
+            const Real * w_re = m_roots_re.data() + h;
+            const Real * w_im = m_roots_im.data() + h;
+
+            for (size_t i = 0; i < m_size; i += 2 * h)
+                inverseBlock(re + i, im + i, re + i + h, im + i + h, w_re, w_im, h);
+        }
+
+        for (size_t i = 0; i < m_size; ++i)
+        {
+            re[i] = re[i] * m_inverse_size;
+            im[i] = im[i] * m_inverse_size;
+        }
+    }
+
+    // Cached plan for n points, built on first use; thread safe
+    static ScalarFFTPlan const & get(size_t n)
+    {
+        static std::mutex mutex;
+        static std::map<size_t, std::unique_ptr<ScalarFFTPlan>> plans;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto & plan = plans[n];
+        if (!plan)
+            plan.reset(new ScalarFFTPlan(n));
+        return *plan;
+    }
+
+private:
+    // x, y = x + y, (x - y) * w over the halves of a block
+    static void forwardBlock(Real * __restrict__ x_re, Real * __restrict__ x_im,
+                             Real * __restrict__ y_re, Real * __restrict__ y_im,
+                             const Real * w_re, const Real * w_im, size_t h)
+    {
+        for (size_t j = 0; j < h; ++j)
+        {
+            const Real d_re = x_re[j] - y_re[j];
+            const Real d_im = x_im[j] - y_im[j];
+            x_re[j] = x_re[j] + y_re[j];
+            x_im[j] = x_im[j] + y_im[j];
+            y_re[j] = d_re * w_re[j] - d_im * w_im[j];
+            y_im[j] = d_re * w_im[j] + d_im * w_re[j];
+        }
+    }
+
+    // x, y = x + y * conj(w), x - y * conj(w)
+    static void inverseBlock(Real * __restrict__ x_re, Real * __restrict__ x_im,
+                             Real * __restrict__ y_re, Real * __restrict__ y_im,
+                             const Real * w_re, const Real * w_im, size_t h)
+    {
+        for (size_t j = 0; j < h; ++j)
+        {
+            const Real v_re = y_re[j] * w_re[j] + y_im[j] * w_im[j];
+            const Real v_im = y_im[j] * w_re[j] - y_re[j] * w_im[j];
+            y_re[j] = x_re[j] - v_re;
+            y_im[j] = x_im[j] - v_im;
+            x_re[j] = x_re[j] + v_re;
+            x_im[j] = x_im[j] + v_im;
+        }
+    }
+
+    // w_n^k = e^(2*pi*i*k/n) for k < max(n/2, 1)
+    static void unitRoots(size_t n, std::vector<Real> & re, std::vector<Real> & im)
+    {
+        const size_t h = std::max<size_t>(n / 2, 1);
+        re.resize(h);
+        im.resize(h);
+
+        if constexpr (std::is_same<Real, DoubleDouble>::value)
+        {
+            // w_n^(2^b) by half angles from w_4 = i: cos(t/2) = sqrt((1 + cos t) / 2),
+            // sin(t/2) = sin t / (2 cos(t/2)); index b holds w_n^(2^b)
+            std::vector<Real> c(1, Real(-1)), s(1, Real(0));
+            if (n >= 4)
+            {
+                c.assign(1, Real(0));
+                s.assign(1, Real(1));
+                for (size_t m = 4; m < n; m <<= 1)
+                {
+                    const Real cm = sqrt((Real(1) + c.front()) * Real(0.5));
+                    s.insert(s.begin(), s.front() / (Real(2) * cm));
+                    c.insert(c.begin(), cm);
+                }
+            }
+
+            // w^k for k in [2^b, 2^(b+1)) is w^(k - 2^b) * w^(2^b)
+            re[0] = Real(1);
+            im[0] = Real(0);
+            for (size_t b = 0; (size_t(1) << b) < h; ++b)
+            {
+                const size_t first = size_t(1) << b;
+                for (size_t k = first; k < std::min(2 * first, h); ++k)
+                {
+                    re[k] = re[k - first] * c[b] - im[k - first] * s[b];
+                    im[k] = re[k - first] * s[b] + im[k - first] * c[b];
+                }
+            }
+        }
+        else
+        {
+            for (size_t k = 0; k < h; ++k)
+            {
+                const long double theta = 2 * M_PIl * k / n;
+                re[k] = Real(std::cos(theta));
+                im[k] = Real(std::sin(theta));
+            }
+        }
+    }
+
+private:
+    size_t            m_size;
+    std::vector<Real> m_roots_re;
+    std::vector<Real> m_roots_im;
+    Real              m_inverse_size;
+};
+
+/*
+ * Per-thread buffers, as fft_workspace: at least n elements, kept for the
+ * next call
+ */
+const size_t SCALAR_FFT_WORKSPACE_SLOTS = 2;
+
+template<typename Real>
+Real * scalar_fft_workspace(size_t slot, size_t n)
+{
+    thread_local std::vector<Real> buffers[SCALAR_FFT_WORKSPACE_SLOTS];
+
+    if (slot >= SCALAR_FFT_WORKSPACE_SLOTS)
+        throw std::out_of_range("scalar FFT workspace slot out of range");
+
+    auto & b = buffers[slot];
+    if (b.size() < n)
+        b.resize(n);
+    return b.data();
+}
+
+/*
+ * Linear convolution of real sequences a and b (a.size() + b.size() - 1
+ * values) by transforms of scalar Real. With z = a + i*b, z^2 has the
+ * transform Z^2 and the imaginary part 2 * (a * b), so one forward and one
+ * inverse transform of complex data are enough, and without the mirror
+ * indices that the bit reversed spectrum would make awkward.
+ */
+template<typename Real, typename T>
+std::vector<Real> fft_convolution(std::vector<T> const & a, std::vector<T> const & b)
+{
+    if (a.empty() || b.empty())
+        return {};
+
+    const size_t result_size = a.size() + b.size() - 1;
+
+    size_t n = 1;
+    while (n < result_size)
+        n <<= 1;
+
+    Real * re = scalar_fft_workspace<Real>(0, n);
+    Real * im = scalar_fft_workspace<Real>(1, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        re[i] = (i < a.size()) ? Real(a[i]) : Real(0);
+        im[i] = (i < b.size()) ? Real(b[i]) : Real(0);
+    }
+
+    ScalarFFTPlan<Real> const & plan = ScalarFFTPlan<Real>::get(n);
+    plan.forward(re, im);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Real r = re[i];
+        re[i] = r * r - im[i] * im[i];
+        im[i] = Real(2) * r * im[i];
+    }
+
+    plan.inverse(re, im);
+
+    std::vector<Real> c(result_size);
+    for (size_t i = 0; i < result_size; ++i)
+        c[i] = im[i] * Real(0.5);
+    return c;
+}
+
+/*
+ * Cheapest exact transform for the product of operands of length_a and
+ * length_b coeficients of absolute value at most coef_bound, with an
+ * estimated rounding error
+ *
+ *     coef_bound^2 * min(length_a, length_b) * log2(n) * unit roundoff
+ *
+ * below FFT_ROUNDING_MARGIN, so that integer results round exactly; n is
+ * the transform size of the whole product, length_a + length_b - 1 rounded
+ * up to a power of 2. DOUBLE is FFTPlan (Polynomial::FFT_multiplication),
+ * DOUBLE_DOUBLE is ScalarFFTPlan<DoubleDouble>, whose unit roundoff is
+ * taken as 2^-100 for the error of its roots. NONE when even DoubleDouble
+ * is not enough (use the NTT).
+ *
+ */
+enum class FFTPrecision { DOUBLE, DOUBLE_DOUBLE, NONE };
+
+const double FFT_ROUNDING_MARGIN = 1.0 / 256;
+
+inline FFTPrecision fft_precision(size_t length_a, size_t length_b, double coef_bound)
+{
+    const size_t shorter = std::min(length_a, length_b);
+    if (shorter == 0)
+        return FFTPrecision::DOUBLE;
+
+    size_t n = 1;
+    while (n < length_a + length_b - 1)
+        n <<= 1;
+
+    double log_n = 1;
+    for (size_t m = n; m > 2; m >>= 1)
+        ++log_n;
+
+    const double growth = coef_bound * coef_bound * double(shorter) * log_n;
+
+    if (growth * std::ldexp(1.0, -53) <= FFT_ROUNDING_MARGIN)
+        return FFTPrecision::DOUBLE;
+    if (growth * std::ldexp(1.0, -100) <= FFT_ROUNDING_MARGIN)
+        return FFTPrecision::DOUBLE_DOUBLE;
+    return FFTPrecision::NONE;
+}
+
+#endif
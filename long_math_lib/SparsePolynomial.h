@@ -0,0 +1,294 @@
+#ifndef _SPARSE_POLYNOMIAL_H_
+#define _SPARSE_POLYNOMIAL_H_
+
+#include <vector>
+#include <queue>
+#include <utility>
+#include <algorithm>
+#include <ostream>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "Polynomial.h"
+
+/*
+ * Polynomial stored as its nonzero terms (exponent, coeficient), sorted by
+ * increasing exponent, so that memory and time depend on the number of
+ * terms rather than on the degree.
+ *
+ * Products use Johnson's heap algorithm: the terms of the product come out
+ * in exponent order from a heap holding one candidate per term of the
+ * shorter factor, t1 * t2 * log(min(t1, t2)) operations and no dense array.
+ * When the factors are dense enough for the product to be dense as well,
+ * they are converted to Polynomial and multiplied by the FFT instead; for
+ * floating point coeficients that product has rounding noise in every
+ * coeficient, which is dropped (see denseProduct). True terms within that
+ * noise are dropped with it, so the number of terms of a floating point
+ * product depends on the path taken: heapProduct keeps them all.
+ */
+template<typename CoefType>
+class SparsePolynomial
+{
+public:
+    using Exponent   = uint64_t;
+    using Term       = std::pair<Exponent, CoefType>;
+    using TermVector = std::vector<Term>;
+
+    SparsePolynomial() {}
+
+    // Terms in any order; equal exponents are added, zero terms dropped
+    SparsePolynomial(TermVector terms)
+        : m_terms(std::move(terms))
+    {
+        std::stable_sort(m_terms.begin(), m_terms.end(),
+                         [] (Term const & l, Term const & r) { return l.first < r.first; });
+
+        size_t out = 0;
+        for (size_t i = 0; i < m_terms.size(); )
+        {
+            Term t = m_terms[i];
+            for (++i; i < m_terms.size() && m_terms[i].first == t.first; ++i)
+                t.second = t.second + m_terms[i].second;
+
+            if (!(t.second == CoefType(0)))
+                m_terms[out++] = t;
+        }
+        m_terms.resize(out);
+    }
+
+    explicit SparsePolynomial(Polynomial<CoefType> const & dense)
+    {
+        for (size_t i = 0; i < dense.size(); ++i)
+        {
+            if (!(dense[i] == CoefType(0)))
+                m_terms.emplace_back(i, dense[i]);
+        }
+    }
+
+    TermVector const & terms() const { return m_terms; }
+
+    bool isZero() const { return m_terms.empty(); }
+
+    // Degree, 0 for the zero polynomial
+    Exponent degree() const { return m_terms.empty() ? 0 : m_terms.back().first; }
+
+    // Number of terms over the number of coeficients up to the degree
+    double density() const { return double(m_terms.size()) / (double(degree()) + 1); }
+
+    // Coeficient of x^e, by binary search
+    CoefType coefficient(Exponent e) const
+    {
+        auto it = std::lower_bound(m_terms.begin(), m_terms.end(), e,
+                                   [] (Term const & t, Exponent x) { return t.first < x; });
+        return (it != m_terms.end() && it->first == e) ? it->second : CoefType(0);
+    }
+
+    Polynomial<CoefType> toDense() const
+    {
+        std::vector<CoefType> coefs(m_terms.empty() ? 0 : degree() + 1, CoefType(0));
+        for (auto const & t : m_terms)
+            coefs[t.first] = t.second;
+        return Polynomial<CoefType>(coefs);
+    }
+
+    /*
+     * Value at x by Horner's method over the terms, the powers of x for the
+     * gaps between exponents by repeated squaring
+     */
+    template<typename T>
+    T operator()(T const & x) const
+    {
+        T res = T(0);
+        Exponent previous = degree();
+
+        for (auto it = m_terms.rbegin(); it != m_terms.rend(); ++it)
+        {
+            res = res * power(x, previous - it->first) + T(it->second);
+            previous = it->first;
+        }
+        return res * power(x, previous);
+    }
+
+    SparsePolynomial operator+(SparsePolynomial const & p) const { return merge(p, false); }
+    SparsePolynomial operator-(SparsePolynomial const & p) const { return merge(p, true); }
+
+    SparsePolynomial operator*(SparsePolynomial const & p) const
+    {
+        if (isZero() || p.isZero())
+            return SparsePolynomial();
+
+        const double work = double(m_terms.size()) * double(p.m_terms.size());
+        if (work >= DENSE_RATIO * (double(degree()) + double(p.degree()) + 1))
+            return denseProduct(p);
+
+        return heapProduct(p);
+    }
+
+    /*
+     * Product by Johnson's algorithm only, the heap running over the terms
+     * of the shorter factor. Exact sparsity for floating point coeficients:
+     * every nonzero sum is a term, however small, where operator* may take
+     * the dense product and drop the small ones (see DENSE_RATIO).
+     */
+    SparsePolynomial heapProduct(SparsePolynomial const & p) const
+    {
+        if (isZero() || p.isZero())
+            return SparsePolynomial();
+
+        TermVector const & a = (m_terms.size() <= p.m_terms.size()) ? m_terms : p.m_terms;
+        TermVector const & b = (m_terms.size() <= p.m_terms.size()) ? p.m_terms : m_terms;
+
+        // (exponent of a[i] * b[j], i, j), smallest exponent on top
+        using Entry = std::pair<Exponent, std::pair<size_t, size_t>>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+
+        for (size_t i = 0; i < a.size(); ++i)
+            heap.push({ a[i].first + b[0].first, { i, 0 } });
+
+        SparsePolynomial r;
+        while (!heap.empty())
+        {
+            const Exponent e = heap.top().first;
+            CoefType c = CoefType(0);
+
+            while (!heap.empty() && heap.top().first == e)
+            {
+                const size_t i = heap.top().second.first;
+                const size_t j = heap.top().second.second;
+                heap.pop();
+
+                c = c + a[i].second * b[j].second;
+                if (j + 1 < b.size())
+                    heap.push({ a[i].first + b[j + 1].first, { i, j + 1 } });
+            }
+
+            if (!(c == CoefType(0)))
+                r.m_terms.emplace_back(e, c);
+        }
+        return r;
+    }
+
+    void operator+=(SparsePolynomial const & p) { m_terms = merge(p, false).m_terms; }
+    void operator-=(SparsePolynomial const & p) { m_terms = merge(p, true).m_terms; }
+    void operator*=(SparsePolynomial const & p) { m_terms = (*this * p).m_terms; }
+
+    bool operator==(SparsePolynomial const & p) const { return m_terms == p.m_terms; }
+    bool operator!=(SparsePolynomial const & p) const { return !(*this == p); }
+
+    template<typename T>
+    friend std::ostream & operator<<(std::ostream &, SparsePolynomial<T> const &);
+
+private:
+    /*
+     * Above this many term products per coeficient of the result, the
+     * dense FFT product is cheaper than the heap. For floating point
+     * coeficients it also drops the terms below its rounding error, small
+     * true ones included (see denseProduct).
+     */
+    static constexpr double DENSE_RATIO = 0.5;
+
+    template<typename T>
+    static T power(T x, Exponent e)
+    {
+        T r = T(1);
+        for (; e != 0; e >>= 1)
+        {
+            if (e & 1)
+                r = r * x;
+            x = x * x;
+        }
+        return r;
+    }
+
+    SparsePolynomial merge(SparsePolynomial const & p, bool subtract) const
+    {
+        SparsePolynomial r;
+        r.m_terms.reserve(m_terms.size() + p.m_terms.size());
+
+        auto a = m_terms.begin(), b = p.m_terms.begin();
+        while (a != m_terms.end() || b != p.m_terms.end())
+        {
+            if (b == p.m_terms.end() || (a != m_terms.end() && a->first < b->first))
+            {
+                r.m_terms.push_back(*a++);
+                continue;
+            }
+
+            CoefType c = subtract ? CoefType(0) - b->second : b->second;
+            Exponent e = b->first;
+            ++b;
+
+            if (a != m_terms.end() && a->first == e)
+                c = (a++)->second + c;
+
+            if (!(c == CoefType(0)))
+                r.m_terms.emplace_back(e, c);
+        }
+        return r;
+    }
+
+    /*
+     * Product of the dense Polynomials. The FFT leaves floating point
+     * coeficients with errors of the order of eps * |a| * |b| * log2(n)
+     * (2-norms, n coeficients), the coeficients that should be zero
+     * included; below that bound they are dropped as noise (measured noise
+     * stays under a fifth of it). True coeficients that small are dropped
+     * as well, they are within the rounding error of the product.
+     */
+    SparsePolynomial denseProduct(SparsePolynomial const & p) const
+    {
+        SparsePolynomial r(toDense() * p.toDense());
+
+        if constexpr (std::is_floating_point<CoefType>::value)
+        {
+            using std::abs;
+
+            const double size = double(degree()) + double(p.degree()) + 1;
+            const double tolerance = std::numeric_limits<CoefType>::epsilon()
+                                   * norm() * p.norm() * std::log2(size + 1);
+
+            r.m_terms.erase(std::remove_if(r.m_terms.begin(), r.m_terms.end(),
+                                           [&] (Term const & t) { return abs(t.second) <= tolerance; }),
+                            r.m_terms.end());
+        }
+        return r;
+    }
+
+    // Euclidean norm of the coeficients
+    double norm() const
+    {
+        double sum = 0;
+        for (auto const & t : m_terms)
+            sum += double(t.second) * double(t.second);
+        return std::sqrt(sum);
+    }
+
+private:
+    TermVector m_terms;
+};
+
+template<typename T>
+std::ostream & operator<<(std::ostream & os, SparsePolynomial<T> const & p)
+{
+    for (auto it = p.m_terms.rbegin(); it != p.m_terms.rend(); ++it)
+    {
+        // negative coeficients bring their own sign, residues have none
+        if (it != p.m_terms.rbegin())
+        {
+            if constexpr (is_mod_int<T>::value)
+                os << "+";
+            else if (!(it->second < T(0)))
+                os << "+";
+        }
+
+        os << it->second;
+
+        if (it->first != 0)
+            os << "*x^" << it->first;
+    }
+    return os;
+}
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef _STREAMING_CONVOLVER_H_
+#define _STREAMING_CONVOLVER_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Polynomial.h"
+
+/*
+ * Convolution of an unbounded stream of samples with a fixed kernel, by
+ * uniformly partitioned overlap-add: the kernel is cut into partitions of
+ * block_size coeficients whose spectra are computed once, and each block of
+ * input is transformed once and kept in a delay line of the last spectra.
+ * The output of a block is the inverse transform of the sum of the delayed
+ * input spectra times the kernel spectra, plus the tail of the previous
+ * block.
+ *
+ * Every block_size input samples cost one forward and one inverse real
+ * transform of about 2 * block_size points (FFTPlan::forwardReal) and one
+ * pointwise product per partition, whatever the length of the stream.
+ * Memory is two spectra per partition; output comes block_size samples at a
+ * time, block_size samples behind the input.
+ *
+ * Rounding is that of FFT_multiplication, integer results are exact while
+ * they need at most FFT_EXACT_BITS bits.
+ */
+template<typename CoefType>
+class StreamingConvolver
+{
+    static_assert(std::is_arithmetic<CoefType>::value, "StreamingConvolver needs real coeficients");
+
+public:
+    using Poly       = Polynomial<CoefType>;
+    using CoefVector = typename Poly::CoefVector;
+
+    StreamingConvolver(Poly const & kernel, size_t block_size)
+        : m_block(block_size)
+        , m_kernel_size(kernel.size())
+    {
+        if (kernel.size() == 0)
+            throw std::invalid_argument("StreamingConvolver needs a kernel");
+        if (block_size == 0)
+            throw std::invalid_argument("StreamingConvolver needs a block size");
+
+        // a block and a kernel partition give 2 * block_size - 1 coeficients
+        m_plan = &FFTPlan::get(FFTPlan::goodSize(2 * m_block));
+        m_partitions = (m_kernel_size + m_block - 1) / m_block;
+
+        const size_t h = half();
+        m_kernel_re.resize(m_partitions * h);
+        m_kernel_im.resize(m_partitions * h);
+
+        std::vector<double> part(m_block);
+        for (size_t p = 0; p < m_partitions; ++p)
+        {
+            const size_t first = p * m_block;
+            const size_t len = std::min(m_block, m_kernel_size - first);
+
+            for (size_t i = 0; i < m_block; ++i)
+                part[i] = (i < len) ? double(kernel[first + i]) : 0;
+
+            load(part.data(), m_block, &m_kernel_re[p * h], &m_kernel_im[p * h]);
+            m_plan->forwardReal(&m_kernel_re[p * h], &m_kernel_im[p * h]);
+        }
+
+        m_history_re.resize(m_partitions * h);
+        m_history_im.resize(m_partitions * h);
+        m_sum_re.resize(h);
+        m_sum_im.resize(h);
+        m_tail.resize(transformSize() - m_block);
+        m_input.reserve(m_block);
+
+        reset();
+    }
+
+    size_t blockSize() const { return m_block; }
+
+    size_t transformSize() const { return m_plan->size(); }
+
+    // Number of kernel partitions, the pointwise products per block
+    size_t partitions() const { return m_partitions; }
+
+    /*
+     * Takes count input samples and appends to out the output samples they
+     * complete: block_size samples for each full block of input
+     */
+    void push(const CoefType * in, size_t count, CoefVector & out)
+    {
+        while (count > 0)
+        {
+            const size_t len = std::min(count, m_block - m_input.size());
+            for (size_t i = 0; i < len; ++i)
+                m_input.push_back(double(in[i]));
+
+            in += len;
+            count -= len;
+            m_consumed += len;
+
+            if (m_input.size() == m_block)
+                processBlock(out);
+        }
+    }
+
+    void push(CoefVector const & in, CoefVector & out)
+    {
+        push(in.data(), in.size(), out);
+    }
+
+    /*
+     * Ends the stream: appends the remaining output samples, up to the
+     * length of the full convolution, and gets ready for a new stream
+     */
+    void flush(CoefVector & out)
+    {
+        if (m_consumed > 0)
+        {
+            const size_t total = m_consumed + m_kernel_size - 1;
+            while (m_emitted < total)
+            {
+                m_input.resize(m_block, 0);
+                processBlock(out);
+            }
+            out.resize(out.size() - (m_emitted - total));
+        }
+        reset();
+    }
+
+private:
+    size_t half() const { return transformSize() / 2; }
+
+    void reset()
+    {
+        std::fill(m_history_re.begin(), m_history_re.end(), 0);
+        std::fill(m_history_im.begin(), m_history_im.end(), 0);
+        std::fill(m_tail.begin(), m_tail.end(), 0);
+        m_input.clear();
+        m_head = 0;
+        m_consumed = 0;
+        m_emitted = 0;
+    }
+
+    // samples x[0, len) packed for FFTPlan::forwardReal, zero padded
+    void load(const double * x, size_t len, double * re, double * im) const
+    {
+        for (size_t m = 0; m < half(); ++m)
+        {
+            re[m] = (2 * m     < len) ? x[2 * m]     : 0;
+            im[m] = (2 * m + 1 < len) ? x[2 * m + 1] : 0;
+        }
+    }
+
+    void processBlock(CoefVector & out)
+    {
+        const size_t h = half();
+
+        // the newest spectrum replaces the oldest one of the delay line
+        m_head = (m_head + m_partitions - 1) % m_partitions;
+        double * x_re = &m_history_re[m_head * h];
+        double * x_im = &m_history_im[m_head * h];
+
+        load(m_input.data(), m_block, x_re, x_im);
+        m_plan->forwardReal(x_re, x_im);
+        m_input.clear();
+
+        // partition p meets the input of p blocks ago
+        std::fill(m_sum_re.begin(), m_sum_re.end(), 0);
+        std::fill(m_sum_im.begin(), m_sum_im.end(), 0);
+        for (size_t p = 0; p < m_partitions; ++p)
+        {
+            const size_t slot = (m_head + p) % m_partitions;
+            m_plan->multiplyAddReal(m_sum_re.data(), m_sum_im.data(),
+                                    &m_history_re[slot * h], &m_history_im[slot * h],
+                                    &m_kernel_re[p * h], &m_kernel_im[p * h]);
+        }
+        m_plan->inverseReal(m_sum_re.data(), m_sum_im.data());
+
+        auto sum = [this] (size_t i) { return (i % 2 == 0) ? m_sum_re[i / 2] : m_sum_im[i / 2]; };
+
+        for (size_t i = 0; i < m_block; ++i)
+            out.push_back(Poly::from_real(sum(i) + m_tail[i]));
+
+        // what comes after this block, kept for the next ones
+        const size_t tail = m_tail.size();
+        for (size_t i = 0; i < tail; ++i)
+            m_tail[i] = sum(m_block + i) + ((m_block + i < tail) ? m_tail[m_block + i] : 0);
+
+        m_emitted += m_block;
+    }
+
+private:
+    size_t              m_block;
+    size_t              m_kernel_size;
+    size_t              m_partitions;
+    FFTPlan const *     m_plan;
+
+    // spectra of the kernel partitions, h = transformSize() / 2 values each
+    std::vector<double> m_kernel_re;
+    std::vector<double> m_kernel_im;
+    // spectra of the last m_partitions input blocks, the newest at m_head
+    std::vector<double> m_history_re;
+    std::vector<double> m_history_im;
+    size_t              m_head;
+
+    std::vector<double> m_sum_re;
+    std::vector<double> m_sum_im;
+    // output past the current block, transformSize() - block_size samples
+    std::vector<double> m_tail;
+    // samples of the block being filled
+    std::vector<double> m_input;
+
+    size_t              m_consumed;
+    size_t              m_emitted;
+};
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef _SUBPRODUCT_TREE_H_
+#define _SUBPRODUCT_TREE_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Polynomial.h"
+
+/*
+ * Subproduct tree of a set of points x_0 ... x_(n-1): the leaves are the
+ * polynomials x - x_i, each node is the product of its two children, the root
+ * is M(x) = (x - x_0)...(x - x_(n-1)).
+ *
+ * Multipoint evaluation reduces a polynomial modulo the nodes from the root
+ * down, interpolation combines values from the leaves up, both in
+ * O(n log^2 n) with the FFT (or NTT) multiplication of Polynomial.
+ * Everything that depends only on the points is computed once by the
+ * constructor: the nodes, their PolynomialModulus (the Newton inverses used
+ * by the remainders), and the interpolation weights 1 / M'(x_i). A tree is
+ * immutable afterwards and can be shared by threads.
+ *
+ * Exact with ModInt coeficients. With doubles the products of the nodes grow
+ * quickly, so only a few dozen well spread points are accurate.
+ */
+template<typename CoefType>
+class SubproductTree
+{
+public:
+    using Poly       = Polynomial<CoefType>;
+    using CoefVector = typename Poly::CoefVector;
+
+    explicit SubproductTree(CoefVector const & points)
+        : m_points(points)
+    {
+        if (points.empty())
+            throw std::invalid_argument("SubproductTree needs at least one point");
+
+        std::vector<CoefVector> leaves;
+        for (auto const & x : points)
+            leaves.push_back({ CoefType(0) - x, CoefType(1) });
+        m_levels.push_back(std::move(leaves));
+
+        while (m_levels.back().size() > 1)
+        {
+            std::vector<CoefVector> const & below = m_levels.back();
+            std::vector<CoefVector> level((below.size() + 1) / 2);
+
+            for (size_t j = 0; j < level.size(); ++j)
+            {
+                level[j] = (2 * j + 1 < below.size()) ? multiply(below[2 * j], below[2 * j + 1])
+                                                      : below[2 * j];
+            }
+            m_levels.push_back(std::move(level));
+        }
+
+        // divisors of the remainders, above the directly evaluated nodes
+        m_moduli.resize(m_levels.size());
+        for (size_t k = 0; k < m_levels.size(); ++k)
+        {
+            if ((size_t(1) << k) < EVAL_BLOCK && k + 1 < m_levels.size())
+                continue;
+
+            for (auto const & node : m_levels[k])
+                m_moduli[k].emplace_back(Poly(node));
+        }
+
+        // 1 / M'(x_i), left empty when two points are equal
+        CoefVector derivative(points.size());
+        CoefVector const & m = m_levels.back()[0];
+        for (size_t i = 1; i < m.size(); ++i)
+            derivative[i - 1] = m[i] * CoefType(int64_t(i));
+
+        const CoefVector slopes = evaluate(Poly(derivative));
+        if (std::none_of(slopes.begin(), slopes.end(), [] (CoefType const & s) { return s == CoefType(0); }))
+        {
+            for (auto const & s : slopes)
+                m_weights.push_back(inverse(s));
+        }
+    }
+
+    size_t size() const { return m_points.size(); }
+
+    CoefVector const & points() const { return m_points; }
+
+    // (x - x_0)...(x - x_(n-1))
+    Poly root() const { return Poly(m_levels.back()[0]); }
+
+    // p(x_i) for every point
+    CoefVector evaluate(Poly const & p) const
+    {
+        CoefVector values(size());
+
+        const size_t top = m_levels.size() - 1;
+        descend(top, 0, m_moduli[top][0].reduce(p.coefs()), values.data());
+        return values;
+    }
+
+    /*
+     * The polynomial of degree < n taking the given values at the points,
+     * which must be distinct
+     */
+    Poly interpolate(CoefVector const & values) const
+    {
+        if (values.size() != size())
+            throw std::invalid_argument("one value per interpolation point expected");
+        if (m_weights.empty())
+            throw std::invalid_argument("interpolation points must be distinct");
+
+        // Lagrange: sum of values_i / M'(x_i) * M(x) / (x - x_i), leaves up
+        std::vector<CoefVector> sums(size());
+        for (size_t i = 0; i < size(); ++i)
+            sums[i] = { values[i] * m_weights[i] };
+
+        for (size_t k = 0; k + 1 < m_levels.size(); ++k)
+        {
+            std::vector<CoefVector> const & nodes = m_levels[k];
+            std::vector<CoefVector> next((nodes.size() + 1) / 2);
+
+            for (size_t j = 0; j < next.size(); ++j)
+            {
+                if (2 * j + 1 < nodes.size())
+                    next[j] = add(multiply(sums[2 * j], nodes[2 * j + 1]), multiply(sums[2 * j + 1], nodes[2 * j]));
+                else
+                    next[j] = std::move(sums[2 * j]);
+            }
+            sums = std::move(next);
+        }
+
+        sums[0].resize(size());
+        return Poly(sums[0]);
+    }
+
+private:
+    // Below this many points, remainders are evaluated directly by Horner
+    static const size_t EVAL_BLOCK = 64;
+
+    // Number of points under node j of level k
+    size_t pointCount(size_t k, size_t j) const
+    {
+        const size_t first = j << k;
+        return std::min(size(), first + (size_t(1) << k)) - first;
+    }
+
+    // Writes the values at the points of node j of level k of r, reduced by that node
+    void descend(size_t k, size_t j, CoefVector const & r, CoefType * out) const
+    {
+        if (pointCount(k, j) <= EVAL_BLOCK)
+        {
+            const size_t first = j << k;
+            Poly(r).evaluate(m_points.data() + first, out + first, pointCount(k, j));
+            return;
+        }
+
+        std::vector<CoefVector> const & children = m_levels[k - 1];
+
+        if (2 * j + 1 >= children.size())
+        {
+            // single child, the same polynomial
+            descend(k - 1, 2 * j, r, out);
+            return;
+        }
+
+        for (size_t c = 2 * j; c <= 2 * j + 1; ++c)
+            descend(k - 1, c, m_moduli[k - 1][c].reduce(r), out);
+    }
+
+    static CoefType inverse(CoefType const & c)
+    {
+        if constexpr (is_mod_int<CoefType>::value)
+            return c.inverse();
+        else
+            return CoefType(1) / c;
+    }
+
+    static CoefVector multiply(CoefVector const & a, CoefVector const & b)
+    {
+        return (Poly(a) * Poly(b)).coefs();
+    }
+
+    static CoefVector add(CoefVector a, CoefVector const & b)
+    {
+        a.resize(std::max(a.size(), b.size()), CoefType(0));
+        for (size_t i = 0; i < b.size(); ++i)
+            a[i] += b[i];
+        return a;
+    }
+
+private:
+    CoefVector                           m_points;
+    // m_levels[0] are the leaves, m_levels.back() the root
+    std::vector<std::vector<CoefVector>> m_levels;
+    // for the levels above EVAL_BLOCK points, and the root
+    std::vector<std::vector<PolynomialModulus<CoefType>>> m_moduli;
+    CoefVector                           m_weights;
+};
+
+#endif
@@ -0,0 +1,129 @@
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "DigitKernels.h"
+#include "TestHelpers.h"
+
+using Digits = std::vector<char>;
+
+static std::vector<DigitKernels const *> available_kernels()
+{
+    std::vector<DigitKernels const *> kernels = { &scalar_digit_kernels() };
+
+    if (avx2_digit_kernels())
+        kernels.push_back(avx2_digit_kernels());
+    if (avx512_digit_kernels())
+        kernels.push_back(avx512_digit_kernels());
+
+    return kernels;
+}
+
+// Digits made of 9s and 0s stress the carry and borrow propagation across vector lanes
+TEST(DigitKernels, AddSub)
+{
+    std::mt19937 gen(42);
+    DigitKernels const & ref = scalar_digit_kernels();
+
+    for (auto k : available_kernels())
+    {
+        SCOPED_TRACE(k->name);
+
+        for (size_t len : { 1, 31, 32, 33, 64, 65, 200, 1000 })
+        {
+            for (int pattern = 0; pattern < 3; ++pattern)
+            {
+                Digits a = random_ints<char>(len + 7, 0, 9, gen), b = random_ints<char>(len, 0, 9, gen);
+                if (pattern == 1)
+                {
+                    std::fill(a.begin(), a.end(), 9);
+                    std::fill(b.begin(), b.begin() + len / 2, 9);
+                }
+                else if (pattern == 2)
+                {
+                    std::fill(a.begin(), a.end(), 0);
+                    a.back() = 1;
+                }
+
+                Digits expected(a.size()), out(a.size());
+                EXPECT_EQ(ref.add(a.data(), a.size(), b.data(), b.size(), expected.data())
+                         , k->add(a.data(), a.size(), b.data(), b.size(), out.data()));
+                EXPECT_EQ(expected, out);
+
+                // in place
+                Digits in_place(a);
+                k->add(in_place.data(), in_place.size(), b.data(), b.size(), in_place.data());
+                EXPECT_EQ(expected, in_place);
+
+                ref.sub(a.data(), a.size(), b.data(), b.size(), expected.data());
+                k->sub(a.data(), a.size(), b.data(), b.size(), out.data());
+                EXPECT_EQ(expected, out);
+
+                // (a - b) + b == a
+                k->add(out.data(), out.size(), b.data(), b.size(), out.data());
+                EXPECT_EQ(a, out);
+            }
+        }
+    }
+}
+
+TEST(DigitKernels, Compare)
+{
+    std::mt19937 gen(7);
+
+    for (auto k : available_kernels())
+    {
+        SCOPED_TRACE(k->name);
+
+        for (size_t len : { 0, 1, 32, 63, 64, 65, 300 })
+        {
+            Digits a = random_ints<char>(len, 0, 9, gen);
+            Digits b(a);
+
+            EXPECT_EQ(0, k->compare(a.data(), b.data(), len));
+
+            for (size_t pos = 0; pos < len; pos += 7)
+            {
+                Digits c(a);
+                c[pos] = (c[pos] + 1) % 10;
+
+                const int8_t expected = c[pos] > a[pos] ? 1 : -1;
+                EXPECT_EQ( expected, k->compare(c.data(), a.data(), len));
+                EXPECT_EQ(-expected, k->compare(a.data(), c.data(), len));
+            }
+        }
+    }
+}
+
+TEST(DigitKernels, MulWord)
+{
+    std::mt19937 gen(3);
+    DigitKernels const & ref = scalar_digit_kernels();
+
+    for (auto k : available_kernels())
+    {
+        SCOPED_TRACE(k->name);
+
+        for (size_t len : { 1, 7, 8, 63, 64, 65, 129, 500 })
+        {
+            for (uint32_t factor : { 0u, 1u, 7u, 10u, 99999999u, 4294967295u })
+            {
+                Digits a = random_ints<char>(len, 0, 9, gen);
+                Digits expected(a), out(a);
+
+                EXPECT_EQ(ref.mulWord(expected.data(), len, factor), k->mulWord(out.data(), len, factor));
+                EXPECT_EQ(expected, out);
+            }
+        }
+    }
+}
+
+TEST(DigitKernels, MulWordValue)
+{
+    // 99999999 * 12 = 1199999988
+    Digits d = { 9, 9, 9, 9, 9, 9, 9, 9 };
+
+    EXPECT_EQ(11u, scalar_digit_kernels().mulWord(d.data(), d.size(), 12));
+    EXPECT_EQ(Digits({ 8, 8, 9, 9, 9, 9, 9, 9 }), d);
+}
@@ -0,0 +1,425 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <cmath>
+#include <omp.h>
+
+#include "FFT.h"
+#include "Polynomial.h"
+#include "TestHelpers.h"
+
+using Complex = FFTPlan::Complex;
+using namespace std;
+
+class FFTTestSuite : public ::testing::Test
+{
+};
+
+static vector<Complex> random_complex_vector(size_t n, unsigned seed)
+{
+    mt19937 gen(seed);
+    uniform_real_distribution<double> dis(-1, 1);
+
+    vector<Complex> v(n);
+    for (auto & c : v)
+        c = Complex(dis(gen), dis(gen));
+    return v;
+}
+
+// O(N^2) transform with the same e^(+2*pi*i/n) convention
+static vector<Complex> naive_dft(vector<Complex> const & input)
+{
+    const size_t n = input.size();
+    vector<Complex> out(n);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            const long double theta = 2 * M_PIl * ((j * k) % n) / n;
+            out[k] += input[j] * Complex(cos(theta), sin(theta));
+        }
+    }
+    return out;
+}
+
+static vector<FFTKernels const *> available_fft_kernels()
+{
+    vector<FFTKernels const *> kernels = { &scalar_fft_kernels() };
+
+    if (avx2_fft_kernels())
+        kernels.push_back(avx2_fft_kernels());
+    if (avx512_fft_kernels())
+        kernels.push_back(avx512_fft_kernels());
+
+    return kernels;
+}
+
+// Sizes cover radix-2 and radix-4 passes narrower and wider than the vectors
+TEST_F(FFTTestSuite, MatchesNaiveDFT)
+{
+    for (auto k : available_fft_kernels())
+    {
+        SCOPED_TRACE(k->name);
+
+        for (size_t n = 1; n <= 512; n <<= 1)
+        {
+            SCOPED_TRACE(n);
+
+            const vector<Complex> input = random_complex_vector(n, n);
+            const vector<Complex> expected = naive_dft(input);
+
+            vector<double> re(n), im(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                re[i] = input[i].real();
+                im[i] = input[i].imag();
+            }
+
+            FFTPlan::get(n).forward(re.data(), im.data(), *k);
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                EXPECT_NEAR(expected[i].real(), re[i], 1e-12);
+                EXPECT_NEAR(expected[i].imag(), im[i], 1e-12);
+            }
+        }
+    }
+}
+
+TEST_F(FFTTestSuite, InverseRoundTrip)
+{
+    const size_t n = 1 << 13;
+    const vector<Complex> input = random_complex_vector(n, 7);
+
+    for (auto k : available_fft_kernels())
+    {
+        SCOPED_TRACE(k->name);
+
+        vector<double> re(n), im(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            re[i] = input[i].real();
+            im[i] = input[i].imag();
+        }
+
+        FFTPlan const & plan = FFTPlan::get(n);
+        plan.forward(re.data(), im.data(), *k);
+        plan.inverse(re.data(), im.data(), *k);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            EXPECT_NEAR(input[i].real(), re[i], 1e-14);
+            EXPECT_NEAR(input[i].imag(), im[i], 1e-14);
+        }
+    }
+}
+
+// Four-step transforms, square and not, checked on a sample of outputs
+TEST_F(FFTTestSuite, FourStep)
+{
+    for (size_t n : { 1 << 12, 1 << 13 })
+    {
+        SCOPED_TRACE(n);
+
+        const vector<Complex> input = random_complex_vector(n, 9);
+
+        vector<double> re(n), im(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            re[i] = input[i].real();
+            im[i] = input[i].imag();
+        }
+
+        const FFTPlan plan(n, n);
+        plan.forward(re.data(), im.data());
+
+        mt19937 gen(n);
+        uniform_int_distribution<size_t> dis(0, n - 1);
+
+        for (int sample = 0; sample < 16; ++sample)
+        {
+            const size_t k = (sample == 0) ? 0 : dis(gen);
+
+            complex<long double> expected = 0;
+            for (size_t j = 0; j < n; ++j)
+            {
+                const long double theta = 2 * M_PIl * ((j * k) % n) / n;
+                expected += complex<long double>(input[j]) * complex<long double>(cos(theta), sin(theta));
+            }
+
+            EXPECT_NEAR(double(expected.real()), re[k], 1e-10);
+            EXPECT_NEAR(double(expected.imag()), im[k], 1e-10);
+        }
+
+        plan.inverse(re.data(), im.data());
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            ASSERT_NEAR(input[i].real(), re[i], 1e-14);
+            ASSERT_NEAR(input[i].imag(), im[i], 1e-14);
+        }
+
+        // the real convolution takes its roots from the four-step tables
+        vector<double> expected_re = re, expected_im = im;
+        FFTPlan::get(n).convolveReal(expected_re.data(), expected_im.data());
+        plan.convolveReal(re.data(), im.data());
+
+        for (size_t i = 0; i < n / 2; ++i)
+        {
+            ASSERT_NEAR(expected_re[i], re[i], 1e-10);
+            ASSERT_NEAR(expected_im[i], im[i], 1e-10);
+        }
+    }
+}
+
+// Large transforms are split between threads, compared with a single thread
+TEST_F(FFTTestSuite, ParallelTransform)
+{
+    const size_t n = FFTPlan::PARALLEL_THRESHOLD * 2;
+    const vector<Complex> input = random_complex_vector(n, 5);
+
+    vector<double> re(n), im(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        re[i] = input[i].real();
+        im[i] = input[i].imag();
+    }
+    vector<double> serial_re = re, serial_im = im;
+
+    FFTPlan const & plan = FFTPlan::get(n);
+    const int threads = omp_get_max_threads();
+
+    omp_set_num_threads(1);
+    plan.forward(serial_re.data(), serial_im.data());
+
+    omp_set_num_threads(4);
+    plan.forward(re.data(), im.data());
+    omp_set_num_threads(threads);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(serial_re[i], re[i]);
+        ASSERT_EQ(serial_im[i], im[i]);
+    }
+
+    omp_set_num_threads(4);
+    plan.inverse(re.data(), im.data());
+    omp_set_num_threads(threads);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_NEAR(input[i].real(), re[i], 1e-13);
+        ASSERT_NEAR(input[i].imag(), im[i], 1e-13);
+    }
+}
+
+TEST_F(FFTTestSuite, ConvolveReal)
+{
+    mt19937 gen(3);
+    uniform_real_distribution<double> dis(-10, 10);
+
+    for (size_t n : { 1, 2, 4, 8, 16, 32, 64, 128, 256, 6, 12, 24, 40, 56, 80, 112 })
+    {
+        SCOPED_TRACE(n);
+
+        vector<double> a(n), b(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            a[i] = dis(gen);
+            b[i] = dis(gen);
+        }
+
+        vector<double> re = a, im = b;
+        FFTPlan::get(n).convolveReal(re.data(), im.data());
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            double expected = 0;
+            for (size_t j = 0; j < n; ++j)
+                expected += a[j] * b[(n + k - j) % n];
+
+            const double actual = (k % 2 == 0) ? re[k / 2] : im[k / 2];
+            EXPECT_NEAR(expected, actual, 1e-9);
+        }
+    }
+}
+
+TEST_F(FFTTestSuite, RealTransform)
+{
+    mt19937 gen(4);
+    uniform_real_distribution<double> dis(-10, 10);
+
+    for (size_t n : { 2, 4, 8, 16, 64, 256, 6, 12, 24, 40, 56, 80, 112 })
+    {
+        SCOPED_TRACE(n);
+        const size_t h = n / 2;
+
+        vector<double> a(n), b(n);
+        vector<Complex> x(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            a[i] = dis(gen);
+            b[i] = dis(gen);
+            x[i] = a[i];
+        }
+        const vector<Complex> expected = naive_dft(x);
+
+        vector<double> re(h), im(h), b_re(h), b_im(h);
+        for (size_t m = 0; m < h; ++m)
+        {
+            re[m]   = a[2 * m];
+            im[m]   = a[2 * m + 1];
+            b_re[m] = b[2 * m];
+            b_im[m] = b[2 * m + 1];
+        }
+
+        FFTPlan const & plan = FFTPlan::get(n);
+        plan.forwardReal(re.data(), im.data());
+
+        EXPECT_NEAR(expected[0].real(), re[0], 1e-9);
+        EXPECT_NEAR(expected[h].real(), im[0], 1e-9);
+        for (size_t k = 1; k < h; ++k)
+        {
+            EXPECT_NEAR(expected[k].real(), re[k], 1e-9);
+            EXPECT_NEAR(expected[k].imag(), im[k], 1e-9);
+        }
+
+        // cyclic convolution through the spectra
+        plan.forwardReal(b_re.data(), b_im.data());
+        plan.multiplyReal(re.data(), im.data(), b_re.data(), b_im.data());
+        plan.inverseReal(re.data(), im.data());
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            double c = 0;
+            for (size_t j = 0; j < n; ++j)
+                c += a[j] * b[(n + k - j) % n];
+
+            EXPECT_NEAR(c, (k % 2 == 0) ? re[k / 2] : im[k / 2], 1e-9);
+        }
+    }
+}
+
+TEST_F(FFTTestSuite, PlanCache)
+{
+    EXPECT_EQ(&FFTPlan::get(1024), &FFTPlan::get(1024));
+    EXPECT_EQ(1024u, FFTPlan::get(1024).size());
+
+    EXPECT_THROW(FFTPlan(0),  std::invalid_argument);
+    EXPECT_THROW(FFTPlan(11), std::invalid_argument);
+    EXPECT_THROW(FFTPlan(36), std::invalid_argument);
+    EXPECT_EQ(12u, FFTPlan::get(12).size());
+}
+
+// Sizes m * 2^k for each odd part m, with the 2^k part below and above the
+// vector width
+TEST_F(FFTTestSuite, MixedRadix)
+{
+    for (size_t n : { 3, 5, 7, 6, 12, 20, 28, 96, 160, 224, 768, 1280, 1792 })
+    {
+        SCOPED_TRACE(n);
+
+        const vector<Complex> input = random_complex_vector(n, n);
+        const vector<Complex> expected = naive_dft(input);
+
+        vector<double> re(n), im(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            re[i] = input[i].real();
+            im[i] = input[i].imag();
+        }
+
+        FFTPlan const & plan = FFTPlan::get(n);
+        plan.forward(re.data(), im.data());
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            EXPECT_NEAR(expected[i].real(), re[i], 1e-11);
+            EXPECT_NEAR(expected[i].imag(), im[i], 1e-11);
+        }
+
+        plan.inverse(re.data(), im.data());
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            EXPECT_NEAR(input[i].real(), re[i], 1e-14);
+            EXPECT_NEAR(input[i].imag(), im[i], 1e-14);
+        }
+    }
+}
+
+TEST_F(FFTTestSuite, GoodSize)
+{
+    size_t pow2 = 2;
+
+    for (size_t n = 1; n <= 5000; ++n)
+    {
+        if (pow2 < n)
+            pow2 <<= 1;
+
+        // never more than the padding to a power of 2, and usable by convolveReal
+        const size_t size = FFTPlan::goodSize(n);
+
+        ASSERT_LE(n, size);
+        ASSERT_LE(size, pow2);
+        ASSERT_EQ(0u, size % 2);
+        ASSERT_NO_THROW(FFTPlan::get(size / 2));
+    }
+
+    EXPECT_EQ(1024u, FFTPlan::goodSize(1024));
+    EXPECT_EQ(5u << 13, FFTPlan::goodSize(40000));
+    EXPECT_GT(1u << 22, FFTPlan::goodSize((1 << 21) + 1));
+}
+
+
+TEST_F(FFTTestSuite, Workspace)
+{
+    double * small = fft_workspace(0, 16);
+    double * again = fft_workspace(0, 8);
+
+    // a smaller request reuses the same buffer
+    EXPECT_EQ(small, again);
+    EXPECT_NE(fft_workspace(0, 16), fft_workspace(1, 16));
+}
+
+TEST_F(FFTTestSuite, ConcurrentMultiplication)
+{
+    mt19937 gen(11);
+    const vector<double> coefs = random_ints<double>(3000, 0, 9, gen);
+
+    Polynomial<double> expected(coefs);
+    expected.FFT_multiplication(Polynomial<double>(coefs));
+
+    const size_t threads = 4;
+    vector<Polynomial<double>> results(threads, Polynomial<double>(coefs));
+    vector<thread> workers;
+
+    for (size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t] { results[t].FFT_multiplication(Polynomial<double>(coefs)); });
+    }
+    for (auto & w : workers)
+        w.join();
+
+    for (auto const & r : results)
+    {
+        ASSERT_EQ(expected.size(), r.size());
+        for (size_t i = 0; i < r.size(); ++i)
+            EXPECT_EQ(round(expected[i]), round(r[i]));
+    }
+}
+
+TEST_F(FFTTestSuite, IntegerCoefficientsAreRounded)
+{
+    vector<int64_t> coefs(2000, 7);
+
+    Polynomial<int64_t> p(coefs);
+    p.FFT_multiplication(Polynomial<int64_t>(coefs));
+
+    ASSERT_EQ(3999u, p.size());
+    for (size_t i = 0; i < p.size(); ++i)
+    {
+        EXPECT_EQ(49 * int64_t(std::min(i + 1, p.size() - i)), p[i]);
+    }
+}
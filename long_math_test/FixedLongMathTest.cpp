@@ -0,0 +1,125 @@
+
+#include <gtest/gtest.h>
+#include <ostream>
+
+#include "FixedLongMath.h"
+
+using namespace fixed_long_math_literals;
+
+// Evaluated by the compiler, these fail the build if constexpr arithmetic breaks
+static_assert(FixedLongMath256(2) + FixedLongMath256(3) == FixedLongMath256(5), "constexpr add");
+static_assert(FixedLongMath256(2) - FixedLongMath256(3) == FixedLongMath256(0) - FixedLongMath256(1), "constexpr sub");
+static_assert(0xFFFFFFFFFFFFFFFF_flm256 * 0xFFFFFFFFFFFFFFFF_flm256 == 0xFFFFFFFFFFFFFFFE0000000000000001_flm256, "constexpr mul");
+static_assert(12345678901234567890123_flm256 > 12345678901234567890122_flm256, "constexpr compare");
+
+TEST(FixedLongMath, DefaultValue)
+{
+    FixedLongMath256 f;
+    EXPECT_TRUE(f.isZero());
+    EXPECT_EQ(f, FixedLongMath256(0));
+}
+
+TEST(FixedLongMath, Literal)
+{
+    constexpr auto f = 0x1'0000'0000_flm256;
+
+    EXPECT_EQ(0u, f[0]);
+    EXPECT_EQ(1u, f[1]);
+    EXPECT_EQ(f, 4294967296_flm256);
+}
+
+TEST(FixedLongMath, LiteralPrefixes)
+{
+    // as for built-in integer literals: a leading 0 is octal, 0b binary
+    static_assert(0777_flm256 == FixedLongMath256(0777), "octal literal");
+    static_assert(0b101_flm256 == FixedLongMath256(5), "binary literal");
+
+    EXPECT_EQ(FixedLongMath256(0),   0_flm256);
+    EXPECT_EQ(FixedLongMath256(8),   010_flm256);
+    EXPECT_EQ(FixedLongMath256(10),  0B1010_flm256);
+    EXPECT_EQ(FixedLongMath256(255), 0b1111'1111_flm256);
+    EXPECT_EQ(0x1'0000'0000_flm256,  040000000000_flm256);
+
+    EXPECT_THROW(FixedLongMath256::parse("09", 2), std::invalid_argument);
+    EXPECT_THROW(FixedLongMath256::parse("0b102", 5), std::invalid_argument);
+}
+
+TEST(FixedLongMath, AdditionCarry)
+{
+    FixedLongMath512 f(0xFFFFFFFFFFFFFFFFull);
+    f += FixedLongMath512(1);
+
+    EXPECT_EQ(0u, f[0]);
+    EXPECT_EQ(0u, f[1]);
+    EXPECT_EQ(1u, f[2]);
+}
+
+TEST(FixedLongMath, Wraparound)
+{
+    FixedLongMath256 zero;
+    FixedLongMath256 max = zero - FixedLongMath256(1);
+
+    for (size_t i = 0; i < FixedLongMath256::LIMBS; ++i)
+    {
+        EXPECT_EQ(0xFFFFFFFFu, max[i]);
+    }
+
+    EXPECT_EQ(zero, max + FixedLongMath256(1));
+    EXPECT_EQ(FixedLongMath256(1), max * max);
+}
+
+TEST(FixedLongMath, Compare)
+{
+    FixedLongMath1024 l1(9), l2(2);
+    FixedLongMath1024 big = 0x10000000000000000000000000000000000000000_flm1024;
+
+    EXPECT_TRUE(l2 < l1);
+    EXPECT_EQ(-1, l2.compare(l1));
+    EXPECT_EQ( 1, big.compare(l1));
+    EXPECT_EQ( 0, big.compare(big));
+    EXPECT_TRUE(big >= big);
+}
+
+TEST(FixedLongMath, Multiplication)
+{
+    auto l = 123456789012_flm256;
+    auto r = 987654321098_flm256;
+
+    EXPECT_EQ(121932631136585886175176_flm256, l * r);
+}
+
+TEST(FixedLongMath, ToLongMath)
+{
+    LongMath l = 121932631136585886175176_flm2048;
+    std::ostringstream oss;
+
+    oss << l;
+    EXPECT_EQ("+121932631136585886175176", oss.str());
+
+    EXPECT_TRUE(FixedLongMath2048().toLongMath().isZero());
+}
+
+TEST(FixedLongMath, FromLongMath)
+{
+    LongMath l("121932631136585886175176");
+
+    EXPECT_EQ(121932631136585886175176_flm256, FixedLongMath256(l));
+    EXPECT_EQ(FixedLongMath256(0) - FixedLongMath256(12563), FixedLongMath256(LongMath(-12563)));
+}
+
+TEST(FixedLongMath, MixedWithLongMath)
+{
+    auto f = 99999999999999999999_flm256;
+    LongMath l(1);
+
+    EXPECT_EQ(LongMath("100000000000000000000"), l + f);
+    EXPECT_EQ(100000000000000000000_flm256, FixedLongMath256(l + f));
+}
+
+TEST(FixedLongMath, ParseErrors)
+{
+    EXPECT_THROW(FixedLongMath256::parse("12a", 3), std::invalid_argument);
+
+    const std::string too_big(80, '9');
+    EXPECT_THROW(FixedLongMath256::parse(too_big.c_str(), too_big.size()), std::out_of_range);
+}
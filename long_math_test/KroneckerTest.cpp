@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <random>
+
+#include "Kronecker.h"
+#include "Polynomial.h"
+#include "TestHelpers.h"
+
+using namespace std;
+
+class KroneckerTestSuite : public ::testing::Test
+{
+};
+
+TEST_F(KroneckerTestSuite, SmallProduct)
+{
+    // (1 - 2x + 3x^2) * (-4 + 5x) = -4 + 13x - 22x^2 + 15x^3
+    const vector<int64_t> r = kronecker_product<int64_t>({ 1, -2, 3 }, { -4, 5 });
+    EXPECT_EQ((vector<int64_t>{ -4, 13, -22, 15 }), r);
+
+    // leading coeficient negative, zeros in between and at the top
+    EXPECT_EQ((vector<int64_t>{ 0, 0, 6, 0, 0 }), kronecker_product<int64_t>({ 0, -2, 0 }, { 0, -3, 0 }));
+    EXPECT_EQ((vector<int64_t>{ 0, 0 }), kronecker_product<int64_t>({ 0 }, { 0, 0 }));
+    EXPECT_TRUE(kronecker_product<int64_t>({}, { 1 }).empty());
+}
+
+TEST_F(KroneckerTestSuite, MatchesNaiveProduct)
+{
+    mt19937_64 gen(1);
+
+    for (int64_t bound : { int64_t(1), int64_t(9), int64_t(1) << 20, int64_t(1) << 30 })
+    {
+        SCOPED_TRACE(bound);
+        const vector<int64_t> c1 = random_ints<int64_t>(700, -bound, bound, gen);
+        const vector<int64_t> c2 = random_ints<int64_t>(500, -bound, bound, gen);
+
+        Polynomial<int64_t> naive(c1), kronecker(c1);
+        naive.naive_multiplication(Polynomial<int64_t>(c2));
+        kronecker.kronecker_multiplication(Polynomial<int64_t>(c2));
+
+        EXPECT_EQ(naive, kronecker);
+    }
+}
+
+TEST_F(KroneckerTestSuite, LongMathCoefficients)
+{
+    mt19937 gen(2);
+
+    auto random_long = [&] (size_t digits)
+    {
+        LongMath r(random_digits(digits, gen));
+        if (gen() % 2 == 0)
+            r.opposite();
+        return r;
+    };
+
+    vector<LongMath> c1, c2;
+    for (size_t i = 0; i < 40; ++i)
+        c1.push_back(random_long(1 + i % 60));
+    for (size_t i = 0; i < 30; ++i)
+        c2.push_back(random_long(1 + (7 * i) % 50));
+
+    Polynomial<LongMath> product(c1);
+    product *= Polynomial<LongMath>(c2);
+
+    ASSERT_EQ(69u, product.size());
+    for (size_t k = 0; k < product.size(); ++k)
+    {
+        LongMath expected;
+        for (size_t i = 0; i < c1.size(); ++i)
+        {
+            if (k >= i && k - i < c2.size())
+                expected = expected + c1[i] * c2[k - i];
+        }
+        EXPECT_EQ(expected, product[k]) << k;
+    }
+}
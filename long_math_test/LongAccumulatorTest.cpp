@@ -0,0 +1,105 @@
+
+#include <gtest/gtest.h>
+#include <random>
+
+#include "LongAccumulator.h"
+#include "TestHelpers.h"
+
+// Up to max_len digits, either sign
+static LongMath random_long_math(std::mt19937 & gen, size_t max_len)
+{
+    std::uniform_int_distribution<size_t> len_dis(1, max_len);
+
+    LongMath l(random_digits(len_dis(gen), gen));
+    if (gen() % 2 == 0)
+    {
+        l.opposite();
+    }
+    return l;
+}
+
+TEST(LongAccumulator, Empty)
+{
+    LongAccumulator acc;
+    EXPECT_TRUE(acc.value().isZero());
+}
+
+TEST(LongAccumulator, Sum)
+{
+    LongAccumulator acc(LongMath(100));
+    acc += LongMath(-250);
+    acc += LongMath(5);
+
+    EXPECT_EQ(LongMath(-145), acc.value());
+
+    acc -= LongMath(-145);
+    EXPECT_TRUE(acc.value().isZero());
+}
+
+TEST(LongAccumulator, ManyTerms)
+{
+    // enough terms to run out of headroom several times
+    std::mt19937 gen(11);
+    LongAccumulator acc;
+    LongMath expected;
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        const LongMath term = random_long_math(gen, 40);
+        acc += term;
+        expected = expected + term;
+
+        EXPECT_LE(acc.bound(), LongAccumulator::LIMB_MAX);
+    }
+
+    EXPECT_EQ(expected, acc.value());
+
+    acc.normalize();
+    EXPECT_EQ(expected, acc.value());
+}
+
+TEST(LongAccumulator, NegativeTotal)
+{
+    LongAccumulator acc;
+    acc += LongMath(1);
+    acc -= LongMath("1000000000000");
+
+    EXPECT_EQ(LongMath("-999999999999"), acc.value());
+
+    acc.normalize();
+    EXPECT_EQ(LongMath("-999999999999"), acc.value());
+
+    acc += LongMath("1000000000000");
+    EXPECT_EQ(LongMath(1), acc.value());
+}
+
+TEST(LongAccumulator, DotProduct)
+{
+    std::mt19937 gen(5);
+    LongAccumulator acc;
+    LongMath expected;
+
+    for (int i = 0; i < 500; ++i)
+    {
+        // short factors take the schoolbook path, long ones a digit convolution
+        const size_t max_len = (i % 10 == 0) ? 120 : 30;
+        const LongMath a = random_long_math(gen, max_len), b = random_long_math(gen, max_len);
+
+        acc.addProduct(a, b);
+        expected = expected + a * b;
+    }
+
+    EXPECT_EQ(expected, acc.value());
+
+    // transform sized factors of both signs, carries of several digits
+    for (int i = 0; i < 6; ++i)
+    {
+        const LongMath a = random_long_math(gen, 6000);
+        const LongMath b = (i == 0) ? LongMath(std::string(5000, '9')) : random_long_math(gen, 6000);
+
+        acc.addProduct(a, b);
+        expected = expected + a * b;
+        EXPECT_LE(acc.bound(), LongAccumulator::LIMB_MAX);
+    }
+    EXPECT_EQ(expected, acc.value());
+}
@@ -0,0 +1,183 @@
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include "LongMathIO.h"
+#include "TestHelpers.h"
+
+TEST(LongMathIO, RoundTrip)
+{
+    LongMath l("-98765432109876543210987654321");
+    std::stringstream ss;
+
+    serialize(ss, l);
+
+    EXPECT_EQ(LONG_MATH_HEADER_SIZE + 29, ss.str().size());
+    EXPECT_EQ(l, deserialize(ss));
+}
+
+TEST(LongMathIO, Packed)
+{
+    LongMath l("-98765432109876543210987654321");
+    std::stringstream ss;
+
+    // 29 digits in two limbs of 19
+    serialize(ss, l, LimbFormat::PACKED);
+
+    EXPECT_EQ(LONG_MATH_HEADER_SIZE + 2 * 8, ss.str().size());
+    EXPECT_EQ(l, deserialize(ss));
+
+    // several blocks, a partial top limb, and the extremes of a limb
+    std::mt19937 gen(1);
+    for (std::string const & digits : { random_digits(3000000, gen), std::string(19, '9'),
+                                        std::string(38, '9'), std::string("1") + std::string(19, '0') })
+    {
+        const LongMath big(digits);
+        std::stringstream packed;
+        serialize(packed, big, LimbFormat::PACKED);
+
+        EXPECT_EQ(LONG_MATH_HEADER_SIZE + 8 * ((digits.size() + 18) / 19), packed.str().size());
+        EXPECT_EQ(big, deserialize(packed));
+    }
+
+    std::stringstream zero;
+    serialize(zero, LongMath(0), LimbFormat::PACKED);
+    EXPECT_EQ(LONG_MATH_HEADER_SIZE, zero.str().size());
+    EXPECT_TRUE(deserialize(zero).isZero());
+
+    // a limb of 10^19 or more is not 19 digits
+    std::stringstream bad;
+    serialize(bad, LongMath(123456), LimbFormat::PACKED);
+    std::string bad_limb = bad.str();
+    for (size_t i = 0; i < 8; ++i)
+        bad_limb[LONG_MATH_HEADER_SIZE + i] = char(0xff);
+    std::stringstream bad_limb_ss(bad_limb);
+    EXPECT_THROW(deserialize(bad_limb_ss), std::runtime_error);
+
+    std::string truncated = bad.str();
+    truncated.resize(truncated.size() - 1);
+    std::stringstream truncated_ss(truncated);
+    EXPECT_THROW(deserialize(truncated_ss), std::runtime_error);
+}
+
+TEST(LongMathIO, RoundTripZero)
+{
+    std::stringstream ss;
+
+    serialize(ss, LongMath(0));
+
+    EXPECT_TRUE(deserialize(ss).isZero());
+}
+
+TEST(LongMathIO, Streaming)
+{
+    std::stringstream ss;
+
+    serialize(ss, LongMath(12));
+    serialize(ss, LongMath(-345));
+
+    EXPECT_EQ(LongMath(12),   deserialize(ss));
+    EXPECT_EQ(LongMath(-345), deserialize(ss));
+}
+
+TEST(LongMathIO, Malformed)
+{
+    std::stringstream bad_magic("XXXX");
+    EXPECT_THROW(deserialize(bad_magic), std::runtime_error);
+
+    std::stringstream ss;
+    serialize(ss, LongMath(123456));
+
+    std::string truncated = ss.str();
+    truncated.resize(truncated.size() - 1);
+    std::stringstream truncated_ss(truncated);
+    EXPECT_THROW(deserialize(truncated_ss), std::runtime_error);
+
+    std::string bad_version = ss.str();
+    bad_version[4] = 99;
+    std::stringstream bad_version_ss(bad_version);
+    EXPECT_THROW(deserialize(bad_version_ss), std::runtime_error);
+
+    std::string bad_digit = ss.str();
+    bad_digit[LONG_MATH_HEADER_SIZE] = 10;
+    std::stringstream bad_digit_ss(bad_digit);
+    EXPECT_THROW(deserialize(bad_digit_ss), std::runtime_error);
+}
+
+TEST(LongMathIO, MappedOperand)
+{
+    const std::string path = "LongMathIOTest.lm";
+    const std::string digits(300, '9');
+
+    LongMath big(digits);
+    saveToFile(path, big);
+
+    {
+        MappedLongMath m(path, true);
+
+        EXPECT_EQ(300u, m.size());
+        EXPECT_TRUE(m.checkDigits());
+        EXPECT_FALSE(m.isNegative());
+        EXPECT_EQ(big, m.toLongMath());
+        EXPECT_EQ(big, loadFromFile(path));
+
+        // every multiplication tier reads the mapped digits in place
+        EXPECT_EQ(big * big, big * m.view());
+        EXPECT_EQ(big * LongMath(3), LongMath(3) * m);
+
+        LongMath r(12345678901234);
+        LongMath expected = r * big;
+        r.karatsubaMultiplication(m);
+        EXPECT_EQ(expected, r);
+
+        MappedLongMath moved(std::move(m));
+        EXPECT_EQ(300u, moved.size());
+        EXPECT_EQ(0u, m.size());
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(LongMathIO, MappedMalformed)
+{
+    const std::string path = "LongMathIOTest.lm";
+
+    std::stringstream ss;
+    serialize(ss, LongMath(123456));
+
+    std::string bad_digit = ss.str();
+    bad_digit[LONG_MATH_HEADER_SIZE + 2] = 10;
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << bad_digit;
+    }
+    {
+        // only the header and the size are checked by default
+        MappedLongMath m(path);
+        EXPECT_FALSE(m.checkDigits());
+    }
+    EXPECT_THROW(MappedLongMath m(path, true), std::runtime_error);
+
+    std::string truncated = ss.str();
+    truncated.resize(truncated.size() - 1);
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << truncated;
+    }
+    EXPECT_THROW(MappedLongMath m(path), std::runtime_error);
+
+    // packed limbs are not digits
+    saveToFile(path, LongMath(123456), LimbFormat::PACKED);
+    EXPECT_THROW(MappedLongMath m(path), std::runtime_error);
+    EXPECT_EQ(LongMath(123456), loadFromFile(path));
+
+    std::remove(path.c_str());
+}
+
+TEST(LongMathIO, MissingFile)
+{
+    EXPECT_THROW(MappedLongMath("does/not/exist.lm"), std::system_error);
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <limits>
+
+#include "NTT.h"
+#include "Polynomial.h"
+#include "TestHelpers.h"
+
+using namespace std;
+
+using Mod = ModInt<NTT_PRIME_1>;
+
+class NTTTestSuite : public ::testing::Test
+{
+};
+
+TEST_F(NTTTestSuite, ModIntArithmetic)
+{
+    const uint32_t p = NTT_PRIME_1;
+
+    EXPECT_EQ(0u, Mod().value());
+    EXPECT_EQ(5u, Mod(5).value());
+    EXPECT_EQ(p - 1, Mod(-1).value());
+    EXPECT_EQ(1u, Mod(int64_t(p) + 1).value());
+
+    EXPECT_EQ(Mod(3), Mod(p - 2) + Mod(5));
+    EXPECT_EQ(Mod(-3), Mod(2) - Mod(5));
+    EXPECT_EQ(Mod(-10), -Mod(10));
+
+    mt19937_64 gen(1);
+    uniform_int_distribution<uint32_t> dis(0, p - 1);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        const uint32_t a = dis(gen), b = dis(gen);
+        ASSERT_EQ(uint64_t(a) * b % p, (Mod(a) * Mod(b)).value());
+    }
+
+    EXPECT_EQ(Mod(1), Mod(123456789).inverse() * Mod(123456789));
+    EXPECT_EQ(Mod(1024), Mod(2).pow(10));
+    EXPECT_EQ(Mod(3), Mod::generator());
+}
+
+TEST_F(NTTTestSuite, RoundTrip)
+{
+    mt19937 gen(2);
+
+    for (size_t n = 1; n <= 1024; n <<= 1)
+    {
+        SCOPED_TRACE(n);
+
+        const vector<Mod> a = random_ints<Mod>(n, 0, NTT_PRIME_1 - 1, gen);
+        vector<Mod> b = a;
+
+        NTTPlan<NTT_PRIME_1> const & plan = NTTPlan<NTT_PRIME_1>::get(n);
+        plan.forward(b.data());
+        plan.inverse(b.data());
+
+        EXPECT_EQ(a, b);
+    }
+
+    EXPECT_EQ(&NTTPlan<NTT_PRIME_1>::get(64), &NTTPlan<NTT_PRIME_1>::get(64));
+    EXPECT_THROW(NTTPlan<NTT_PRIME_1>(12), std::invalid_argument);
+    EXPECT_THROW(NTTPlan<NTT_PRIME_1>(1 << 24), std::invalid_argument);
+}
+
+TEST_F(NTTTestSuite, ModIntPolynomial)
+{
+    mt19937 gen(3);
+
+    const vector<Mod> c1 = random_ints<Mod>(1200, 0, NTT_PRIME_1 - 1, gen);
+    const vector<Mod> c2 = random_ints<Mod>(900, 0, NTT_PRIME_1 - 1, gen);
+
+    Polynomial<Mod> naive(c1), ntt(c1), product(c1);
+    naive.naive_multiplication(Polynomial<Mod>(c2));
+    ntt.NTT_multiplication(Polynomial<Mod>(c2));
+    product *= Polynomial<Mod>(c2);
+
+    ASSERT_EQ(2099u, naive.size());
+    EXPECT_EQ(naive, ntt);
+    EXPECT_EQ(naive, product);
+}
+
+// Products far beyond the 53 bits of a double are still exact
+TEST_F(NTTTestSuite, ExactIntegerProduct)
+{
+    mt19937_64 gen(4);
+
+    const vector<int64_t> c1 = random_ints<int64_t>(2000, -(int64_t(1) << 30), int64_t(1) << 30, gen);
+    const vector<int64_t> c2 = random_ints<int64_t>(1000, -(int64_t(1) << 30), int64_t(1) << 30, gen);
+
+    Polynomial<int64_t> naive(c1), product(c1);
+    naive.naive_multiplication(Polynomial<int64_t>(c2));
+    product *= Polynomial<int64_t>(c2);
+
+    ASSERT_EQ(2999u, product.size());
+    EXPECT_EQ(naive, product);
+
+    // outputs up to 1000 * 2^52, close to the int64_t range
+    const int64_t big = int64_t(1) << 26;
+    const vector<int64_t> r = exact_convolution(vector<int64_t>(1000, big), vector<int64_t>(1000, -big));
+
+    ASSERT_EQ(1999u, r.size());
+    EXPECT_EQ(-(int64_t(1) << 52), r.front());
+    EXPECT_EQ(-1000 * (int64_t(1) << 52), r[999]);
+    EXPECT_EQ(-(int64_t(1) << 52), r.back());
+}
+
+// 10^9 + 7 - 1 = 2 * 500000003: no NTT of more than 2 points
+TEST_F(NTTTestSuite, UnfriendlyPrime)
+{
+    using Big = ModInt<1000000007>;
+
+    mt19937 gen(5);
+
+    const vector<Big> c1 = random_ints<Big>(1000, 0, Big::MOD - 1, gen);
+    const vector<Big> c2 = random_ints<Big>(1000, 0, Big::MOD - 1, gen);
+
+    Polynomial<Big> naive(c1), product(c1);
+    naive.naive_multiplication(Polynomial<Big>(c2));
+    product *= Polynomial<Big>(c2);
+
+    ASSERT_EQ(1999u, product.size());
+    EXPECT_EQ(naive, product);
+}
+
+// Longer than a single transform: chunk products added up
+TEST_F(NTTTestSuite, ChunkedConvolution)
+{
+    mt19937_64 gen(6);
+
+    const vector<int64_t> c1 = random_ints<int64_t>(300, -(int64_t(1) << 20), int64_t(1) << 20, gen);
+    const vector<int64_t> c2 = random_ints<int64_t>(77, -(int64_t(1) << 20), int64_t(1) << 20, gen);
+
+    Polynomial<int64_t> naive(c1);
+    naive.naive_multiplication(Polynomial<int64_t>(c2));
+
+    vector<int64_t> chunked(c1.size() + c2.size() - 1, 0);
+    crt_convolution(c1, c2, [&] (size_t i, __int128 x) { chunked[i] += int64_t(x); }, 64);
+
+    EXPECT_EQ(naive.coefs(), chunked);
+    EXPECT_EQ(naive.coefs(), exact_convolution(c1, c2));
+}
@@ -0,0 +1,73 @@
+
+#include <gtest/gtest.h>
+#include <random>
+#include <cstdio>
+
+#include "OutOfCore.h"
+#include "TestHelpers.h"
+
+static void test_out_of_core(LongMath const & l, LongMath const & r, size_t budget)
+{
+    const std::string left_path = "OutOfCoreTest_l.lm", right_path = "OutOfCoreTest_r.lm", result_path = "OutOfCoreTest_res.lm";
+
+    saveToFile(left_path, l);
+    saveToFile(right_path, r);
+
+    OutOfCoreMultiplier m(budget);
+    m.multiply(left_path, right_path, result_path);
+
+    EXPECT_EQ(l * r, loadFromFile(result_path));
+
+    std::remove(left_path.c_str());
+    std::remove(right_path.c_str());
+    std::remove(result_path.c_str());
+}
+
+TEST(OutOfCore, BlockSize)
+{
+    OutOfCoreMultiplier m(0);
+    EXPECT_EQ(OutOfCoreMultiplier::MIN_ROW_SIZE, m.rowSize());
+    EXPECT_EQ(OutOfCoreMultiplier::MIN_ROW_SIZE / 2 * OutOfCoreMultiplier::LIMB_DIGITS, m.blockSize());
+
+    // the largest power of 2 within the budget
+    m.setMemoryBudget(1024 * OutOfCoreMultiplier::ROW_BYTES_PER_POINT);
+    EXPECT_EQ(1024u, m.rowSize());
+    m.setMemoryBudget(1024 * OutOfCoreMultiplier::ROW_BYTES_PER_POINT - 1);
+    EXPECT_EQ(512u, m.rowSize());
+
+    m.setMemoryBudget(size_t(1) << 50);
+    EXPECT_EQ(OutOfCoreMultiplier::MAX_ROW_SIZE, m.rowSize());
+}
+
+TEST(OutOfCore, SingleBlock)
+{
+    test_out_of_core(LongMath(1234), LongMath(5678), OutOfCoreMultiplier::DEFAULT_MEMORY_BUDGET);
+}
+
+TEST(OutOfCore, ManyBlocks)
+{
+    // 128 digits blocks: 16 and 10 rows, panels of a single column
+    std::mt19937 gen(1);
+    LongMath l(random_digits(2000, gen)), r(random_digits(1200, gen));
+    test_out_of_core(l, r, 0);
+
+    l.opposite();
+    test_out_of_core(l, r, 0);
+}
+
+TEST(OutOfCore, WidePanels)
+{
+    // rows of 256 points, 40 and 18 rows, panels of 7 columns
+    std::mt19937 gen(4);
+    LongMath l(random_digits(20000, gen)), r(random_digits(9000, gen));
+    test_out_of_core(l, r, 16 << 10);
+
+    // carries across all the blocks
+    test_out_of_core(LongMath(std::string(20000, '9')), LongMath(std::string(9000, '9')), 16 << 10);
+}
+
+TEST(OutOfCore, Zero)
+{
+    std::mt19937 gen(3);
+    test_out_of_core(LongMath(0), LongMath(random_digits(500, gen)), 0);
+}
@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include <ostream>
+#include <random>
 
 #include "Polynomial.h"
+#include "TestHelpers.h"
 
 using DoublePolynomial = Polynomial<double>;
 using namespace std;
@@ -181,3 +183,319 @@ TEST_F(PolynomialTestSuite, BitReverse)
     EXPECT_EQ(7u, bit_reverse(7, 3));
 }
  
+
+// One million coeficients: no recursion, so no stack overflow
+TEST_F(PolynomialTestSuite, HighDegreeEvaluation)
+{
+    DoublePolynomial p(vector<double>(1000000, 1));
+
+    EXPECT_EQ(1000000, p(1.0));
+    EXPECT_EQ(1000000, p.estrin(1.0));
+    EXPECT_EQ(1, p(0.0));
+}
+
+TEST_F(PolynomialTestSuite, EstrinMatchesHorner)
+{
+    mt19937 gen(1);
+    uniform_real_distribution<double> dis(-1, 1);
+
+    for (size_t n : { 0, 1, 2, 3, 5, 8, 13, 100, 1001 })
+    {
+        SCOPED_TRACE(n);
+
+        vector<double> coefs(n);
+        for (auto & c : coefs)
+            c = dis(gen);
+        DoublePolynomial p(coefs);
+
+        for (double x : { -1.1, -0.5, 0.0, 0.3, 0.99 })
+        {
+            EXPECT_NEAR(p(x), p.estrin(x), 1e-9 * max(1.0, abs(p(x))));
+        }
+        EXPECT_NEAR(abs(p(complex<double>(0.3, 0.4))), abs(p.estrin(complex<double>(0.3, 0.4))), 1e-12);
+    }
+
+    // exact for integers
+    Polynomial<int64_t> q = { 3, -1, 4, 1, -5, 9 };
+    EXPECT_EQ(q(int64_t(7)), q.estrin(int64_t(7)));
+}
+
+TEST_F(PolynomialTestSuite, BatchEvaluation)
+{
+    mt19937 gen(2);
+    uniform_real_distribution<double> dis(-1, 1);
+
+    vector<double> coefs(300);
+    for (auto & c : coefs)
+        c = dis(gen);
+    DoublePolynomial p(coefs);
+
+    // enough points for several blocks and the parallel path
+    vector<double> xs(5000);
+    for (auto & x : xs)
+        x = dis(gen);
+
+    const vector<double> out = p.evaluate(xs);
+
+    ASSERT_EQ(xs.size(), out.size());
+    for (size_t i = 0; i < xs.size(); ++i)
+        ASSERT_EQ(p(xs[i]), out[i]);
+
+    EXPECT_TRUE(DoublePolynomial().evaluate(xs)[0] == 0);
+}
+
+TEST_F(PolynomialTestSuite, DivMod)
+{
+    using Mod = ModInt<NTT_PRIME_1>;
+    mt19937 gen(3);
+
+    auto random_poly = [&] (size_t n) { return Polynomial<Mod>(random_ints<Mod>(n, 0, NTT_PRIME_1 - 1, gen)); };
+
+    // long division and Newton paths, divisor shorter and longer than the dividend
+    for (auto sizes : { make_pair(10, 3), make_pair(3000, 1000), make_pair(5000, 40), make_pair(100, 200), make_pair(7, 1) })
+    {
+        SCOPED_TRACE(sizes.first);
+
+        const Polynomial<Mod> a = random_poly(sizes.first);
+        const Polynomial<Mod> b = random_poly(sizes.second);
+
+        Polynomial<Mod> q, r;
+        a.divmod(b, q, r);
+
+        ASSERT_EQ(b.size() - 1, r.size());
+        EXPECT_EQ(a, q * b + r);
+        EXPECT_EQ(q, a / b);
+        EXPECT_EQ(r, a % b);
+    }
+
+    // zero coeficients of the highest degrees are not part of the divisor
+    DoublePolynomial a = { 1, 2, 1 }, b = { 1, 1, 0, 0 };
+    EXPECT_EQ(DoublePolynomial({ 1, 1 }), a / b);
+    EXPECT_EQ(DoublePolynomial({ 0 }), a % b);
+
+    a %= DoublePolynomial({ 2, 1 });
+    EXPECT_EQ(DoublePolynomial({ 1 }), a);
+
+    EXPECT_THROW(a / DoublePolynomial({ 0, 0 }), std::domain_error);
+}
+
+TEST_F(PolynomialTestSuite, SeriesInverse)
+{
+    // 1 / (1 - x) = 1 + x + x^2 + ...
+    EXPECT_EQ(DoublePolynomial({ 1, 1, 1, 1, 1 }), DoublePolynomial({ 1, -1 }).inverse(5));
+
+    using Mod = ModInt<NTT_PRIME_1>;
+    vector<Mod> c(2000);
+    for (size_t i = 0; i < c.size(); ++i)
+        c[i] = Mod(int64_t(i * i + 1));
+
+    const Polynomial<Mod> p(c);
+    Polynomial<Mod> one = p * p.inverse(1500);
+    one.resize(1500);
+
+    vector<Mod> expected(1500);
+    expected[0] = Mod(1);
+    EXPECT_EQ(Polynomial<Mod>(expected), one);
+
+    // the double transform wraps around too. d is 1 plus terms adding up to
+    // less than 1 in absolute value, no root in the unit disk: 1 / d is bounded
+    mt19937 gen(5);
+    vector<double> d = random_ints<double>(3000, -100, 100, gen);
+    for (size_t i = 0; i < d.size(); ++i)
+        d[i] /= 200.0 * double((i + 1) * (i + 1));
+    d[0] = 1;
+
+    DoublePolynomial d_one = DoublePolynomial(d) * DoublePolynomial(d).inverse(2500);
+    for (size_t i = 0; i < 2500; ++i)
+        EXPECT_NEAR((i == 0) ? 1 : 0, d_one[i], 1e-9) << "at " << i;
+
+    EXPECT_THROW(DoublePolynomial({ 0, 1 }).inverse(4), std::domain_error);
+}
+
+TEST_F(PolynomialTestSuite, Mullo)
+{
+    using Mod = ModInt<NTT_PRIME_1>;
+    mt19937 gen(6);
+
+    for (size_t n : { 0, 1, 7, 300, 1000, 5000 })
+    {
+        SCOPED_TRACE(n);
+
+        const Polynomial<Mod> a(random_ints<Mod>(1000, 0, NTT_PRIME_1 - 1, gen));
+        const Polynomial<Mod> b(random_ints<Mod>(700, 0, NTT_PRIME_1 - 1, gen));
+
+        Polynomial<Mod> expected = a * b;
+        expected.resize(std::min(n, expected.size()));
+        EXPECT_EQ(expected.coefs(), a.mullo(b, n).coefs());
+
+        const Polynomial<int64_t> c(random_ints<int64_t>(n + 3, -1000, 1000, gen));
+        const Polynomial<int64_t> d(random_ints<int64_t>(n / 2 + 1, -1000, 1000, gen));
+
+        Polynomial<int64_t> expected_int = c * d;
+        expected_int.resize(std::min(n, expected_int.size()));
+        EXPECT_EQ(expected_int.coefs(), c.mullo(d, n).coefs());
+    }
+
+    // operands of n coeficients: short Karatsuba, and wrapped transforms with their low end corrected
+    for (size_t n : { 31, 32, 100, 257, 1100, 1500, 3000 })
+    {
+        SCOPED_TRACE(n);
+
+        const Polynomial<Mod> a(random_ints<Mod>(n, 0, NTT_PRIME_1 - 1, gen));
+        const Polynomial<Mod> b(random_ints<Mod>(n, 0, NTT_PRIME_1 - 1, gen));
+
+        Polynomial<Mod> expected = a * b;
+        expected.resize(n);
+        EXPECT_EQ(expected.coefs(), a.mullo(b, n).coefs());
+
+        const Polynomial<int64_t> c(random_ints<int64_t>(n, -1000, 1000, gen));
+        const Polynomial<int64_t> d(random_ints<int64_t>(n, -1000, 1000, gen));
+
+        Polynomial<int64_t> expected_int = c * d;
+        expected_int.resize(n);
+        EXPECT_EQ(expected_int.coefs(), c.mullo(d, n).coefs());
+
+        const DoublePolynomial e(random_ints<double>(n, -1000, 1000, gen));
+        const DoublePolynomial f(random_ints<double>(n, -1000, 1000, gen));
+
+        const DoublePolynomial expected_double = e * f;
+        const DoublePolynomial low = e.mullo(f, n);
+        ASSERT_EQ(n, low.size());
+        for (size_t i = 0; i < n; ++i)
+            EXPECT_NEAR(expected_double[i], low[i], 1e-3) << "at " << i;
+    }
+}
+
+TEST_F(PolynomialTestSuite, Modulus)
+{
+    using Mod = ModInt<NTT_PRIME_1>;
+    vector<Mod> c(300), d(5000);
+    for (size_t i = 0; i < c.size(); ++i)
+        c[i] = Mod(int64_t(3 * i + 7));
+    for (size_t i = 0; i < d.size(); ++i)
+        d[i] = Mod(int64_t(i * i * i + 2));
+
+    const Polynomial<Mod> b(c), a(d);
+    const PolynomialModulus<Mod> modulus(b);
+
+    EXPECT_EQ(299u, modulus.degree());
+    // several steps of the top down reduction
+    EXPECT_EQ(a % b, modulus.reduce(a));
+    EXPECT_EQ((a * a) % b, modulus.multiply(a, a));
+
+    const PolynomialModulus<Mod> constant(Polynomial<Mod>({ Mod(5) }));
+    EXPECT_EQ(0u, constant.reduce(a).size());
+
+    EXPECT_THROW(PolynomialModulus<double>(DoublePolynomial({ 0 })), std::domain_error);
+}
+
+TEST_F(PolynomialTestSuite, Karatsuba)
+{
+    using Mod = ModInt<NTT_PRIME_1>;
+    mt19937_64 gen(11);
+
+    // balanced, unbalanced, and sizes around the recursion thresholds
+    const vector<pair<size_t, size_t>> sizes = { { 1, 1 }, { 31, 33 }, { 64, 64 }, { 65, 200 },
+                                                 { 1000, 37 }, { 777, 555 }, { 3, 2000 } };
+    for (auto const & s : sizes)
+    {
+        const vector<Mod> ca = random_ints<Mod>(s.first, 0, NTT_PRIME_1 - 1, gen);
+        const vector<Mod> cb = random_ints<Mod>(s.second, 0, NTT_PRIME_1 - 1, gen);
+        const vector<int64_t> ia = random_ints<int64_t>(s.first, -(1ll << 27), (1ll << 27) - 1, gen);
+        const vector<int64_t> ib = random_ints<int64_t>(s.second, -(1ll << 27), (1ll << 27) - 1, gen);
+
+        Polynomial<Mod> ma(ca), naive(ca);
+        ma.karatsuba_multiplication(Polynomial<Mod>(cb));
+        naive.naive_multiplication(Polynomial<Mod>(cb));
+        EXPECT_EQ(naive, ma);
+        EXPECT_EQ(naive, Polynomial<Mod>(ntt_convolution<NTT_PRIME_1>(ca, cb)));
+
+        // exact with 62 bit intermediate results
+        Polynomial<int64_t> a(ia);
+        a.karatsuba_multiplication(Polynomial<int64_t>(ib));
+        EXPECT_EQ(exact_convolution(ia, ib), a.coefs());
+        EXPECT_EQ(exact_convolution(ia, ib), (Polynomial<int64_t>(ia) * Polynomial<int64_t>(ib)).coefs());
+    }
+}
+
+TEST_F(PolynomialTestSuite, TransformedPolynomial)
+{
+    mt19937 gen(12);
+
+    const vector<int64_t> filter = random_ints<int64_t>(300, -1000, 1000, gen);
+    const TransformedPolynomial<int64_t> t(Polynomial<int64_t>(filter), 1000);
+
+    EXPECT_EQ(300u, t.size());
+    EXPECT_LE(1000u, t.factorSize());
+    EXPECT_EQ(t.transformSize(), t.factorSize() + 299);
+
+    // one product, and several pieces of the factor
+    for (size_t n : { 1, 17, 1000, 5000 })
+    {
+        const vector<int64_t> a = random_ints<int64_t>(n, -1000, 1000, gen);
+        EXPECT_EQ(exact_convolution(a, filter), t.multiply(Polynomial<int64_t>(a)).coefs());
+    }
+
+    const DoublePolynomial p { 1, 2, 3 };
+    const TransformedPolynomial<double> u(DoublePolynomial({ 1, -1 }), 2);
+    const DoublePolynomial r = u.multiply(p);
+    ASSERT_EQ(4u, r.size());
+    EXPECT_NEAR(1, r[0], 1e-12);
+    EXPECT_NEAR(1, r[1], 1e-12);
+    EXPECT_NEAR(1, r[2], 1e-12);
+    EXPECT_NEAR(-3, r[3], 1e-12);
+
+    EXPECT_EQ(0u, u.multiply(DoublePolynomial()).size());
+    EXPECT_THROW(TransformedPolynomial<double>(p, 0), std::invalid_argument);
+}
+
+TEST_F(PolynomialTestSuite, ProductTree)
+{
+    using Mod = ModInt<NTT_PRIME_1>;
+
+    // (x - 1)(x - 2)...(x - n), against a left to right fold
+    for (size_t n : { 1, 2, 3, 7, 100, 3000 })
+    {
+        vector<Polynomial<Mod>> factors;
+        vector<Mod> fold = { Mod(1) };
+        for (size_t i = 1; i <= n; ++i)
+        {
+            factors.push_back(Polynomial<Mod>{ Mod(-int64_t(i)), Mod(1) });
+
+            vector<Mod> next(fold.size() + 1);
+            for (size_t k = 0; k < fold.size(); ++k)
+            {
+                next[k]     -= fold[k] * Mod(int64_t(i));
+                next[k + 1] += fold[k];
+            }
+            fold.swap(next);
+        }
+
+        EXPECT_EQ(Polynomial<Mod>(fold), polynomial_product(factors));
+    }
+
+    // factors of different sizes and a LongMath range
+    const vector<DoublePolynomial> mixed = { { 1, 1 }, { 1, 2, 1 }, { 2 }, { 0, 1 }, { 1, -1 } };
+    EXPECT_EQ(DoublePolynomial({ 0, 2, 4, 0, -4, -2 }), polynomial_product(mixed.begin(), mixed.end()));
+
+    const vector<Polynomial<LongMath>> big = { { LongMath("100000000000000000000"), LongMath(1) },
+                                               { LongMath(-1), LongMath("100000000000000000000") } };
+    const Polynomial<LongMath> p = polynomial_product(big);
+    ASSERT_EQ(3u, p.size());
+    EXPECT_EQ(LongMath("-100000000000000000000"), p[0]);
+    EXPECT_EQ(LongMath("9999999999999999999999999999999999999999"), p[1]);
+    EXPECT_EQ(LongMath("100000000000000000000"), p[2]);
+
+    // one long factor among short ones, in any position
+    mt19937 gen(7);
+    Polynomial<Mod> long_factor(random_ints<Mod>(5000, 0, NTT_PRIME_1 - 1, gen));
+    vector<Polynomial<Mod>> uneven(9, Polynomial<Mod>{ Mod(1), Mod(1) });
+    uneven[3] = long_factor;
+
+    Polynomial<Mod> expected = long_factor;
+    for (size_t i = 0; i < 8; ++i)
+        expected *= Polynomial<Mod>{ Mod(1), Mod(1) };
+    EXPECT_EQ(expected, polynomial_product(uneven));
+
+    EXPECT_EQ(DoublePolynomial({ 1 }), polynomial_product(vector<DoublePolynomial>()));
+}
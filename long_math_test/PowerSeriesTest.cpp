@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+
+#include "PowerSeries.h"
+#include "TestHelpers.h"
+
+using namespace std;
+
+using Mod = ModInt<NTT_PRIME_1>;
+using ModSeries = PowerSeries<Mod>;
+
+class PowerSeriesTestSuite : public ::testing::Test
+{
+};
+
+static ModSeries random_series(size_t n, unsigned seed, int64_t constant)
+{
+    mt19937 gen(seed);
+
+    vector<Mod> c = random_ints<Mod>(n, 0, NTT_PRIME_1 - 1, gen);
+    c[0] = Mod(constant);
+    return ModSeries(c, n);
+}
+
+TEST_F(PowerSeriesTestSuite, Reciprocal)
+{
+    // 1 / (1 - x)
+    const PowerSeries<double> s(vector<double>{ 1, -1 }, 6);
+    EXPECT_EQ(vector<double>(6, 1), s.reciprocal().coefs());
+
+    for (size_t n : { 1, 5, 100, 3000 })
+    {
+        const ModSeries f = random_series(n, unsigned(n), 7);
+        const ModSeries one = f * f.reciprocal();
+
+        EXPECT_EQ(Mod(1), one[0]);
+        for (size_t i = 1; i < n; ++i)
+            ASSERT_EQ(Mod(0), one[i]);
+    }
+}
+
+TEST_F(PowerSeriesTestSuite, LogExp)
+{
+    // exp(x) = sum x^i / i!
+    const PowerSeries<double> e = PowerSeries<double>(vector<double>{ 0, 1 }, 12).exp();
+    double factorial = 1;
+    for (size_t i = 0; i < 12; ++i)
+    {
+        factorial *= max<size_t>(i, 1);
+        EXPECT_NEAR(1 / factorial, e[i], 1e-15);
+    }
+
+    for (size_t n : { 1, 2, 17, 2000 })
+    {
+        SCOPED_TRACE(n);
+
+        const ModSeries f = random_series(n, unsigned(n), 1);
+        EXPECT_EQ(f, f.log().exp());
+
+        const ModSeries g = random_series(n, unsigned(n) + 1, 0);
+        EXPECT_EQ(g, g.exp().log());
+    }
+
+    EXPECT_THROW(random_series(4, 1, 2).log(), std::domain_error);
+    EXPECT_THROW(random_series(4, 1, 1).exp(), std::domain_error);
+}
+
+TEST_F(PowerSeriesTestSuite, Sqrt)
+{
+    for (size_t n : { 1, 3, 64, 2500 })
+    {
+        SCOPED_TRACE(n);
+
+        const ModSeries f = random_series(n, unsigned(n), 1);
+        const ModSeries r = f.sqrt();
+        EXPECT_EQ(f, r * r);
+    }
+
+    // sqrt(1 + x) = 1 + x/2 - x^2/8 + x^3/16
+    const PowerSeries<double> s = PowerSeries<double>(vector<double>{ 1, 1 }, 4).sqrt();
+    EXPECT_NEAR(0.5,    s[1], 1e-15);
+    EXPECT_NEAR(-0.125, s[2], 1e-15);
+    EXPECT_NEAR(0.0625, s[3], 1e-15);
+}
+
+TEST_F(PowerSeriesTestSuite, Compose)
+{
+    for (size_t n : { 1, 10, 16, 17, 300 })
+    {
+        SCOPED_TRACE(n);
+
+        const ModSeries f = random_series(n, unsigned(n), 3);
+        const Polynomial<Mod> q = { Mod(0), Mod(2), Mod(5), Mod(-1) };
+
+        // Horner, truncated at each step
+        vector<Mod> expected = { f[n - 1] };
+        for (size_t i = n - 1; i-- > 0; )
+        {
+            expected = (Polynomial<Mod>(expected) * q).coefs();
+            expected.resize(n);
+            expected[0] += f[i];
+        }
+
+        EXPECT_EQ(ModSeries(expected, n), f.compose(q));
+    }
+
+    // f(x + 1) for the polynomial 1 + x^2: 2 + 2x + x^2
+    const PowerSeries<double> f(vector<double>{ 1, 0, 1 }, 3);
+    EXPECT_EQ((vector<double>{ 2, 2, 1 }), f.compose(Polynomial<double>({ 1, 1 })).coefs());
+}
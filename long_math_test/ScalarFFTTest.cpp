@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <random>
+
+#include "Polynomial.h"
+#include "ScalarFFT.h"
+#include "TestHelpers.h"
+
+using namespace std;
+
+class ScalarFFTTestSuite : public ::testing::Test
+{
+};
+
+template<typename Real>
+static void check_convolution(size_t na, size_t nb, int64_t bound, mt19937 & gen)
+{
+    const vector<int64_t> a = random_ints<int64_t>(na, -bound, bound, gen);
+    const vector<int64_t> b = random_ints<int64_t>(nb, -bound, bound, gen);
+    const vector<int64_t> expected = exact_convolution(a, b);
+
+    const vector<Real> c = fft_convolution<Real>(a, b);
+    ASSERT_EQ(expected.size(), c.size());
+    for (size_t i = 0; i < c.size(); ++i)
+    {
+        using std::llround;
+        ASSERT_EQ(expected[i], llround(c[i])) << "at " << i;
+    }
+}
+
+TEST_F(ScalarFFTTestSuite, DoubleDouble)
+{
+    // every 64-bit integer is exact and rounds back to itself
+    for (int64_t v : { int64_t(0), int64_t(-1), (int64_t(1) << 62) + 1, INT64_MAX, INT64_MIN + 1 })
+        EXPECT_EQ(v, llround(DoubleDouble(v)));
+
+    const DoubleDouble third = DoubleDouble(1) / DoubleDouble(3);
+    EXPECT_NEAR(0, double((third * DoubleDouble(3) - DoubleDouble(1))), 1e-30);
+    EXPECT_NE(0, third.lo());
+
+    const DoubleDouble root = sqrt(DoubleDouble(2));
+    EXPECT_NEAR(0, double(root * root - DoubleDouble(2)), 1e-30);
+    EXPECT_EQ(0, double(sqrt(DoubleDouble(0))));
+
+    // 2^60 + 1 - 2^60 survives, it would not in a double
+    const DoubleDouble big = DoubleDouble(int64_t(1) << 60) + DoubleDouble(1);
+    EXPECT_EQ(1, llround(big - DoubleDouble(int64_t(1) << 60)));
+    EXPECT_TRUE(DoubleDouble(int64_t(1) << 60) < big);
+}
+
+TEST_F(ScalarFFTTestSuite, RoundTrip)
+{
+    mt19937 gen(1);
+    uniform_real_distribution<double> dis(-1, 1);
+
+    for (size_t n : { 1, 2, 4, 64, 1024 })
+    {
+        vector<double> re(n), im(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            re[i] = dis(gen);
+            im[i] = dis(gen);
+        }
+
+        vector<double> re_d(re), im_d(im);
+        ScalarFFTPlan<double>::get(n).forward(re_d.data(), im_d.data());
+        ScalarFFTPlan<double>::get(n).inverse(re_d.data(), im_d.data());
+
+        vector<DoubleDouble> re_dd(re.begin(), re.end()), im_dd(im.begin(), im.end());
+        ScalarFFTPlan<DoubleDouble>::get(n).forward(re_dd.data(), im_dd.data());
+        ScalarFFTPlan<DoubleDouble>::get(n).inverse(re_dd.data(), im_dd.data());
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            EXPECT_NEAR(re[i], re_d[i], 1e-13);
+            EXPECT_NEAR(im[i], im_d[i], 1e-13);
+            EXPECT_NEAR(0, double(re_dd[i] - DoubleDouble(re[i])), 1e-28);
+            EXPECT_NEAR(0, double(im_dd[i] - DoubleDouble(im[i])), 1e-28);
+        }
+    }
+
+    // the forward transform of a unit impulse at 1 holds the roots
+    vector<double> re(8, 0), im(8, 0);
+    re[1] = 1;
+    ScalarFFTPlan<double>::get(8).forward(re.data(), im.data());
+    EXPECT_NEAR(1, re[0], 1e-15);   // w^0, bit reversed index 0
+    EXPECT_NEAR(1, im[2], 1e-15);   // w^2 = i at bit reversed index 2
+
+    EXPECT_THROW(ScalarFFTPlan<double>(0), std::invalid_argument);
+    EXPECT_THROW(ScalarFFTPlan<double>(12), std::invalid_argument);
+}
+
+TEST_F(ScalarFFTTestSuite, Convolution)
+{
+    mt19937 gen(2);
+
+    check_convolution<double>(1, 1, 100, gen);
+    check_convolution<double>(200, 37, 100, gen);
+    check_convolution<double>(1000, 1000, 1 << 16, gen);
+    check_convolution<DoubleDouble>(1000, 1000, int64_t(1) << 26, gen);
+    check_convolution<DoubleDouble>(3, 5000, int64_t(1) << 30, gen);
+
+    EXPECT_TRUE(fft_convolution<double>(vector<int64_t>(), vector<int64_t>{ 1 }).empty());
+}
+
+TEST_F(ScalarFFTTestSuite, Precision)
+{
+    EXPECT_EQ(FFTPrecision::DOUBLE,        fft_precision(16, 16, 8));
+    EXPECT_EQ(FFTPrecision::DOUBLE,        fft_precision(1000, 1000, 1 << 12));
+    EXPECT_EQ(FFTPrecision::DOUBLE,        fft_precision(1 << 16, 1 << 16, 1 << 10));
+    EXPECT_EQ(FFTPrecision::DOUBLE_DOUBLE, fft_precision(1 << 16, 1 << 16, 1 << 24));
+    EXPECT_EQ(FFTPrecision::NONE,          fft_precision(1 << 20, 1 << 20, 1e15));
+    EXPECT_EQ(FFTPrecision::DOUBLE,        fft_precision(0, 1 << 20, 1e15));
+
+    // the transform size is that of the whole product, the longer operand counts
+    EXPECT_EQ(FFTPrecision::DOUBLE,        fft_precision(1024, 1024, 54000));
+    EXPECT_EQ(FFTPrecision::DOUBLE_DOUBLE, fft_precision(1024, 1 << 20, 54000));
+    EXPECT_EQ(FFTPrecision::DOUBLE_DOUBLE, fft_precision(1 << 20, 1024, 54000));
+
+    // the choice never gets cheaper for longer or larger operands
+    FFTPrecision last = FFTPrecision::DOUBLE;
+    for (size_t length = 1; length < (1 << 24); length *= 4)
+    {
+        const FFTPrecision p = fft_precision(length, length, 1 << 12);
+        EXPECT_LE(int(last), int(p));
+        last = p;
+    }
+
+    // what it picks is exact
+    mt19937 gen(3);
+    for (int64_t bound : { int64_t(1), int64_t(1) << 12, int64_t(1) << 24 })
+    {
+        SCOPED_TRACE(bound);
+        switch (fft_precision(2000, 2000, double(bound)))
+        {
+        case FFTPrecision::DOUBLE:
+        {
+            const vector<int64_t> a = random_ints<int64_t>(2000, -bound, bound, gen);
+            const vector<int64_t> b = random_ints<int64_t>(2000, -bound, bound, gen);
+
+            Polynomial<int64_t> p(a);
+            p.FFT_multiplication(Polynomial<int64_t>(b));
+            EXPECT_EQ(exact_convolution(a, b), p.coefs());
+            break;
+        }
+        case FFTPrecision::DOUBLE_DOUBLE: check_convolution<DoubleDouble>(2000, 2000, bound, gen); break;
+        case FFTPrecision::NONE:          ADD_FAILURE();                                           break;
+        }
+    }
+}
+
+TEST_F(ScalarFFTTestSuite, PolynomialMultiplication)
+{
+    mt19937 gen(4);
+
+    // 2 * 25 + 11 bits, beyond FFT_EXACT_BITS of the double transform
+    const vector<int64_t> a = random_ints<int64_t>(1500, -(int64_t(1) << 25), int64_t(1) << 25, gen);
+    const vector<int64_t> b = random_ints<int64_t>(1500, -(int64_t(1) << 25), int64_t(1) << 25, gen);
+
+    Polynomial<int64_t> p(a);
+    p.FFT_multiplication<DoubleDouble>(Polynomial<int64_t>(b));
+    EXPECT_EQ(exact_convolution(a, b), p.coefs());
+
+    Polynomial<double> q({ 1, 2, 3 });
+    q.FFT_multiplication<DoubleDouble>(Polynomial<double>({ 1, -1 }));
+    ASSERT_EQ(4u, q.size());
+    EXPECT_NEAR(1, q[0], 1e-12);
+    EXPECT_NEAR(1, q[1], 1e-12);
+    EXPECT_NEAR(1, q[2], 1e-12);
+    EXPECT_NEAR(-3, q[3], 1e-12);
+}
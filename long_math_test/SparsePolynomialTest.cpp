@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+
+#include "SparsePolynomial.h"
+#include "TestHelpers.h"
+
+using namespace std;
+
+using Sparse = SparsePolynomial<int64_t>;
+
+class SparsePolynomialTestSuite : public ::testing::Test
+{
+};
+
+static Sparse random_sparse(size_t terms, uint64_t degree, unsigned seed)
+{
+    mt19937_64 gen(seed);
+    const vector<uint64_t> exponents = random_ints<uint64_t>(terms, 0, int64_t(degree), gen);
+    const vector<int64_t> coefs = random_ints<int64_t>(terms, -1000, 1000, gen);
+
+    Sparse::TermVector t(terms);
+    for (size_t i = 0; i < terms; ++i)
+        t[i] = { exponents[i], coefs[i] };
+    return Sparse(t);
+}
+
+TEST_F(SparsePolynomialTestSuite, Construction)
+{
+    // duplicates are added, zeros dropped, terms sorted
+    const Sparse p({ { 5, 2 }, { 0, 1 }, { 5, 3 }, { 2, 0 }, { 7, 4 }, { 7, -4 } });
+
+    EXPECT_EQ(Sparse::TermVector({ { 0, 1 }, { 5, 5 } }), p.terms());
+    EXPECT_EQ(5u, p.degree());
+    EXPECT_EQ(5, p.coefficient(5));
+    EXPECT_EQ(0, p.coefficient(3));
+    EXPECT_DOUBLE_EQ(2.0 / 6, p.density());
+
+    const Polynomial<int64_t> dense(vector<int64_t>{ 1, 0, 0, 0, 0, 5 });
+    EXPECT_EQ(dense.coefs(), p.toDense().coefs());
+    EXPECT_EQ(p, Sparse(dense));
+
+    ostringstream os;
+    os << p;
+    EXPECT_EQ("5*x^5+1", os.str());
+
+    ostringstream negative;
+    negative << Sparse({ { 3, 2 }, { 1, -5 }, { 0, -1 } });
+    EXPECT_EQ("2*x^3-5*x^1-1", negative.str());
+
+    EXPECT_TRUE(Sparse().isZero());
+    EXPECT_TRUE((p - p).isZero());
+}
+
+TEST_F(SparsePolynomialTestSuite, Arithmetic)
+{
+    const Sparse a = random_sparse(30, 100, 1);
+    const Sparse b = random_sparse(40, 120, 2);
+
+    const auto da = a.toDense().coefs();
+    const auto db = b.toDense().coefs();
+
+    vector<int64_t> sum(max(da.size(), db.size()), 0), difference(sum);
+    for (size_t i = 0; i < da.size(); ++i)
+    {
+        sum[i] += da[i];
+        difference[i] += da[i];
+    }
+    for (size_t i = 0; i < db.size(); ++i)
+    {
+        sum[i] += db[i];
+        difference[i] -= db[i];
+    }
+
+    EXPECT_EQ(Sparse(Polynomial<int64_t>(sum)), a + b);
+    EXPECT_EQ(Sparse(Polynomial<int64_t>(difference)), a - b);
+
+    Sparse c = a;
+    c += b;
+    c -= b;
+    EXPECT_EQ(a, c);
+}
+
+TEST_F(SparsePolynomialTestSuite, Multiplication)
+{
+    // sparse factors of a huge degree go through the heap
+    for (unsigned seed : { 3, 4, 5 })
+    {
+        const Sparse a = random_sparse(50, 1000000000000ull, seed);
+        const Sparse b = random_sparse(70, 1000000000000ull, seed + 10);
+
+        Sparse::TermVector naive;
+        for (auto const & x : a.terms())
+        {
+            for (auto const & y : b.terms())
+                naive.emplace_back(x.first + y.first, x.second * y.second);
+        }
+        EXPECT_EQ(Sparse(naive), a * b);
+        EXPECT_EQ(a * b, b * a);
+    }
+
+    // dense enough for the dense product, same result
+    const Sparse a = random_sparse(300, 1000, 6);
+    const Sparse b = random_sparse(200, 800, 7);
+
+    Polynomial<int64_t> dense(a.toDense().coefs());
+    dense *= b.toDense();
+    EXPECT_EQ(Sparse(dense), a * b);
+
+    Sparse c = a;
+    c *= b;
+    EXPECT_EQ(Sparse(dense), c);
+
+    EXPECT_TRUE((a * Sparse()).isZero());
+
+    // (1 - x^n)(1 + x^n + ... + x^(kn)) = 1 - x^((k+1)n)
+    Sparse::TermVector geometric;
+    for (uint64_t k = 0; k < 100; ++k)
+        geometric.emplace_back(k << 40, 1);
+
+    EXPECT_EQ(Sparse({ { 0, 1 }, { 100ull << 40, -1 } }),
+              Sparse({ { 0, 1 }, { 1ull << 40, -1 } }) * Sparse(geometric));
+}
+
+TEST_F(SparsePolynomialTestSuite, FloatingPointDenseProduct)
+{
+    using DoubleSparse = SparsePolynomial<double>;
+    mt19937 gen(8);
+
+    // even exponents only, dense enough for the FFT: no odd noise terms
+    const vector<int64_t> ca = random_ints<int64_t>(1000, 1, 1000, gen);
+    const vector<int64_t> cb = random_ints<int64_t>(1000, -1000, -1, gen);
+
+    DoubleSparse::TermVector ta, tb;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        ta.emplace_back(2 * i, double(ca[i]) / 8);
+        tb.emplace_back(2 * i, double(cb[i]));
+    }
+    const DoubleSparse a(ta), b(tb);
+    ASSERT_GE(double(a.terms().size()) * double(b.terms().size()),
+              0.5 * (double(a.degree()) + double(b.degree()) + 1));
+
+    const DoubleSparse c = a * b;
+    ASSERT_EQ(1999u, c.terms().size());
+
+    // each coeficient against the schoolbook sum, no cancellation: a > 0 > b
+    for (size_t k = 0; k < c.terms().size(); ++k)
+    {
+        double expected = 0;
+        for (size_t i = 0; i <= k; ++i)
+        {
+            if (i < 1000 && k - i < 1000)
+                expected += ta[i].second * tb[k - i].second;
+        }
+        EXPECT_EQ(2 * k, c.terms()[k].first);
+        EXPECT_NEAR(expected, c.terms()[k].second, 1e-6 * std::fabs(expected));
+    }
+
+    // a true term far below the noise bound: dropped by the dense product, kept by the heap
+    DoubleSparse::TermVector tiny = ta;
+    tiny.emplace_back(2001, 1e-30);
+    const DoubleSparse d(tiny);
+    EXPECT_EQ(0, (d * b).coefficient(2001));
+    EXPECT_NE(0, d.heapProduct(b).coefficient(2001));
+    EXPECT_EQ(1999u + 1000u, d.heapProduct(b).terms().size());
+    EXPECT_TRUE(d.heapProduct(DoubleSparse()).isZero());
+}
+
+TEST_F(SparsePolynomialTestSuite, Evaluation)
+{
+    const Sparse p({ { 0, 3 }, { 2, -1 }, { 10, 2 } });
+    EXPECT_EQ(3 - 4 + 2 * 1024, p(int64_t(2)));
+    EXPECT_DOUBLE_EQ(3 - 0.25 + 2 * pow(0.5, 10), p(0.5));
+
+    // x^(10^12) at a root of unity modulo a prime
+    using Mod = ModInt<NTT_PRIME_1>;
+    const SparsePolynomial<Mod> q({ { 1000000000000ull, Mod(1) }, { 1, Mod(5) } });
+    EXPECT_EQ(Mod(1) + Mod(5), q(Mod(1)));
+    EXPECT_EQ(Mod(3).pow(1000000000000ull) + Mod(15), q(Mod(3)));
+
+    EXPECT_EQ(0, Sparse()(int64_t(7)));
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <random>
+
+#include "StreamingConvolver.h"
+#include "TestHelpers.h"
+
+using namespace std;
+
+class StreamingConvolverTestSuite : public ::testing::Test
+{
+};
+
+TEST_F(StreamingConvolverTestSuite, MatchesFullConvolution)
+{
+    mt19937 gen(5);
+
+    // kernels shorter and longer than a block, chunks of any size
+    for (size_t kernel_size : { 1, 5, 100, 1000 })
+    {
+        for (size_t block : { 1, 16, 100, 256 })
+        {
+            // a partition per coeficient, slow and nothing more to check
+            if (block == 1 && kernel_size > 100)
+                continue;
+
+            SCOPED_TRACE(kernel_size * 1000 + block);
+
+            const vector<int64_t> kernel = random_ints<int64_t>(kernel_size, -1000, 1000, gen);
+            const vector<int64_t> input = random_ints<int64_t>(3000, -1000, 1000, gen);
+
+            StreamingConvolver<int64_t> convolver(Polynomial<int64_t>(kernel), block);
+            EXPECT_EQ((kernel_size + block - 1) / block, convolver.partitions());
+            EXPECT_LE(2 * block, convolver.transformSize());
+
+            vector<int64_t> out;
+            uniform_int_distribution<size_t> chunk(0, 3 * block);
+            for (size_t first = 0; first < input.size(); )
+            {
+                const size_t len = min(chunk(gen), input.size() - first);
+                const size_t before = out.size();
+
+                convolver.push(input.data() + first, len, out);
+                first += len;
+
+                // output follows the input block by block
+                EXPECT_EQ(0u, out.size() % block);
+                EXPECT_EQ(first / block * block, out.size());
+                EXPECT_GE(before + len + block, out.size());
+            }
+            convolver.flush(out);
+
+            EXPECT_EQ(exact_convolution(input, kernel), out);
+        }
+    }
+}
+
+TEST_F(StreamingConvolverTestSuite, Reuse)
+{
+    const StreamingConvolver<double>::CoefVector kernel = { 1, -1 };
+    StreamingConvolver<double> convolver(Polynomial<double>(kernel), 4);
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        vector<double> out;
+        convolver.push(vector<double>{ 1, 2, 3 }, out);
+        EXPECT_EQ(0u, out.size());
+
+        convolver.flush(out);
+        ASSERT_EQ(4u, out.size());
+        EXPECT_NEAR(1, out[0], 1e-12);
+        EXPECT_NEAR(1, out[1], 1e-12);
+        EXPECT_NEAR(1, out[2], 1e-12);
+        EXPECT_NEAR(-3, out[3], 1e-12);
+    }
+
+    // an empty stream has no output
+    vector<double> out;
+    convolver.flush(out);
+    EXPECT_EQ(0u, out.size());
+
+    EXPECT_THROW(StreamingConvolver<double>(Polynomial<double>(), 4), std::invalid_argument);
+    EXPECT_THROW(StreamingConvolver<double>(Polynomial<double>(kernel), 0), std::invalid_argument);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <random>
+
+#include "SubproductTree.h"
+#include "TestHelpers.h"
+
+using namespace std;
+
+using Mod = ModInt<NTT_PRIME_1>;
+
+class SubproductTreeTestSuite : public ::testing::Test
+{
+};
+
+// Sizes around the direct evaluation block, and large enough for the NTT
+TEST_F(SubproductTreeTestSuite, EvaluateAndInterpolate)
+{
+    for (size_t n : { 1, 2, 3, 64, 65, 200, 3000 })
+    {
+        SCOPED_TRACE(n);
+
+        mt19937 gen(static_cast<unsigned>(n));
+        const SubproductTree<Mod> tree(random_ints<Mod>(n, 0, NTT_PRIME_1 - 1, gen));
+        const Polynomial<Mod> p(random_ints<Mod>(n, 0, NTT_PRIME_1 - 1, gen));
+
+        const vector<Mod> values = tree.evaluate(p);
+
+        ASSERT_EQ(n, values.size());
+        for (size_t i = 0; i < n; ++i)
+            ASSERT_EQ(p(tree.points()[i]), values[i]);
+
+        EXPECT_EQ(p, tree.interpolate(values));
+    }
+}
+
+// Polynomials of higher degree are first reduced by the root, the tree is
+// reused across calls
+TEST_F(SubproductTreeTestSuite, ReuseAndHighDegree)
+{
+    mt19937 gen(1);
+    const SubproductTree<Mod> tree(random_ints<Mod>(500, 0, NTT_PRIME_1 - 1, gen));
+
+    for (size_t degree : { 10, 499, 1200, 5000 })
+    {
+        const Polynomial<Mod> p(random_ints<Mod>(degree + 1, 0, NTT_PRIME_1 - 1, gen));
+        const vector<Mod> values = tree.evaluate(p);
+
+        for (size_t i = 0; i < tree.size(); i += 7)
+            ASSERT_EQ(p(tree.points()[i]), values[i]);
+    }
+
+    const Polynomial<Mod> root = tree.root();
+    ASSERT_EQ(501u, root.size());
+    for (auto const & x : tree.points())
+        ASSERT_EQ(Mod(0), root(x));
+}
+
+TEST_F(SubproductTreeTestSuite, DoublePoints)
+{
+    vector<double> points;
+    for (int i = 0; i < 16; ++i)
+        points.push_back(cos(M_PI * (i + 0.5) / 16));
+
+    const SubproductTree<double> tree(points);
+    const Polynomial<double> p = { 1, -2, 0.5, 3, 0, 0, 1 };
+
+    const vector<double> values = tree.evaluate(p);
+    for (size_t i = 0; i < points.size(); ++i)
+        EXPECT_NEAR(p(points[i]), values[i], 1e-9);
+
+    // the monomial basis is ill conditioned: the values are reproduced more
+    // accurately than the coeficients
+    const Polynomial<double> q = tree.interpolate(values);
+    for (size_t i = 0; i < points.size(); ++i)
+        EXPECT_NEAR(values[i], q(points[i]), 1e-9);
+    for (size_t i = 0; i < q.size(); ++i)
+        EXPECT_NEAR(i < p.size() ? p[i] : 0.0, q[i], 1e-5);
+}
+
+TEST_F(SubproductTreeTestSuite, InvalidArguments)
+{
+    EXPECT_THROW(SubproductTree<Mod>(vector<Mod>()), std::invalid_argument);
+
+    const SubproductTree<Mod> repeated({ Mod(1), Mod(2), Mod(1) });
+    EXPECT_THROW(repeated.interpolate({ Mod(0), Mod(0), Mod(0) }), std::invalid_argument);
+    EXPECT_EQ(Mod(7), repeated.evaluate(Polynomial<Mod>({ Mod(7) }))[2]);
+
+    const SubproductTree<Mod> tree({ Mod(1), Mod(2) });
+    EXPECT_THROW(tree.interpolate({ Mod(0) }), std::invalid_argument);
+}
@@ -0,0 +1,46 @@
+#ifndef _TEST_HELPERS_H_
+#define _TEST_HELPERS_H_
+
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+ * Random operands for the tests. The generator belongs to the test, so
+ * each test draws a reproducible sequence of its own.
+ */
+
+// n values uniform in [lo, hi], converted to T (integers, ModInt, digits)
+template<typename T, typename Gen>
+std::vector<T> random_ints(size_t n, int64_t lo, int64_t hi, Gen & gen)
+{
+    std::uniform_int_distribution<int64_t> dis(lo, hi);
+
+    std::vector<T> v(n);
+    for (auto & x : v)
+    {
+        x = T(dis(gen));
+    }
+    return v;
+}
+
+// len decimal digits, most significant first and not 0
+template<typename Gen>
+std::string random_digits(size_t len, Gen & gen)
+{
+    std::uniform_int_distribution<int> dis(0, 9);
+
+    std::string s(len, '0');
+    for (auto & c : s)
+    {
+        c = '0' + dis(gen);
+    }
+    if (len > 0)
+    {
+        s[0] = '1' + dis(gen) % 9;
+    }
+    return s;
+}
+
+#endif
@@ -2,8 +2,10 @@
 #include <ostream>
 #include <fstream>
 #include <limits>
+#include <unordered_map>
 
 #include "LongMath.h"
+#include "Polynomial.h"
 
 TEST(LongMath, DefaultValue) 
 {
@@ -64,6 +66,31 @@ TEST(LongMath, TwoDigitAddition)
     EXPECT_EQ(l+k, 201); 
 }
 
+TEST(LongMath, MixedSignAddition)
+{
+    EXPECT_EQ(LongMath(-3),  LongMath(5)  + LongMath(-8));
+    EXPECT_EQ(LongMath(3),   LongMath(-5) + LongMath(8));
+    EXPECT_EQ(LongMath(-13), LongMath(-5) + LongMath(-8));
+    EXPECT_TRUE((LongMath(-5) + LongMath(5)).isZero());
+    EXPECT_FALSE((LongMath(-5) + LongMath(5)).isNegative());
+}
+
+TEST(LongMath, LongAdditionCarry)
+{
+    LongMath l(std::string(200, '9'));
+
+    EXPECT_EQ(LongMath("1" + std::string(200, '0')), l + LongMath(1));
+    EXPECT_EQ(l, LongMath("1" + std::string(200, '0')) - LongMath(1));
+}
+
+TEST(LongMath, MultiplyByInt)
+{
+    LongMath l("123456789012345678901234567890123456789012345678901234567890123456789");
+
+    EXPECT_EQ(LongMath("-2592592569259259256925925925692592592569259259256925925925692592592569"), l * -21);
+    EXPECT_EQ(l + l + l, l * 3);
+}
+
 TEST(LongMath, InitFromString)
 {
     std::string s = "-12563";
@@ -73,6 +100,61 @@ TEST(LongMath, InitFromString)
     EXPECT_EQ(LongMath(s2), 1563);
 }
 
+TEST(LongMath, ToChars)
+{
+    char buf[64];
+
+    auto res = to_chars(buf, buf + sizeof(buf), LongMath(-12563));
+    EXPECT_EQ(std::errc(), res.ec);
+    EXPECT_EQ("-12563", std::string(buf, res.ptr));
+
+    res = to_chars(buf, buf + sizeof(buf), LongMath(0));
+    EXPECT_EQ(std::errc(), res.ec);
+    EXPECT_EQ("0", std::string(buf, res.ptr));
+
+    const std::string long_value = "123456789012345678901234567890123456789";
+    res = to_chars(buf, buf + sizeof(buf), LongMath(long_value));
+    EXPECT_EQ(std::errc(), res.ec);
+    EXPECT_EQ(long_value, std::string(buf, res.ptr));
+
+    res = to_chars(buf, buf + 3, LongMath(-12563));
+    EXPECT_EQ(std::errc::value_too_large, res.ec);
+    EXPECT_EQ(buf + 3, res.ptr);
+}
+
+TEST(LongMath, FromChars)
+{
+    const std::string text = "-98765432109876543210987654321x12";
+    LongMath l(7);
+
+    auto res = from_chars(text.data(), text.data() + text.size(), l);
+    EXPECT_EQ(std::errc(), res.ec);
+    EXPECT_EQ(text.data() + 30, res.ptr);
+    EXPECT_EQ(LongMath("-98765432109876543210987654321"), l);
+
+    const std::string invalid = "-x";
+    res = from_chars(invalid.data(), invalid.data() + invalid.size(), l);
+    EXPECT_EQ(std::errc::invalid_argument, res.ec);
+    EXPECT_EQ(invalid.data(), res.ptr);
+    EXPECT_EQ(LongMath("-98765432109876543210987654321"), l);
+}
+
+TEST(LongMath, InitFromInvalidString)
+{
+    EXPECT_THROW(LongMath("12345678901234567890a"), std::invalid_argument);
+    EXPECT_THROW(LongMath("123\xff"), std::invalid_argument);
+}
+
+TEST(LongMath, DumpLong)
+{
+    const std::string digits(10000, '7');
+    std::ostringstream oss;
+
+    oss << LongMath(digits);
+
+    EXPECT_EQ("+" + digits, oss.str());
+}
+
 TEST(LongMath, ReallyLong)
 {
     std::ifstream f("input.txt");
@@ -178,6 +260,24 @@ TEST(LongMath, MultiplyBy111)
     test_mult(left_factor, right_factor, result, "MultiplyByTen");
 }
 
+TEST(LongMath, MultiplyNegativeByPositive)
+{
+    LongMath left_factor(-1234);
+    LongMath right_factor(5678);
+    LongMath result(-7006652);
+
+    test_mult(left_factor, right_factor, result, "MultiplyNegativeByPositive");
+}
+
+TEST(LongMath, MultiplyNegativeByNegative)
+{
+    LongMath left_factor(-1234);
+    LongMath right_factor(-5678);
+    LongMath result(7006652);
+
+    test_mult(left_factor, right_factor, result, "MultiplyNegativeByNegative");
+}
+
 TEST(LongMath, 2DigitsProduct)
 {
     LongMath left_factor(47);
@@ -278,14 +378,107 @@ TEST(LongMath, IsZero)
    EXPECT_TRUE(LongMath("0000").isZero());
 }
 
+TEST(LongMath, CanonicalForm)
+{
+    LongMath z1("0000"), z2("-0"), z3(LongMath::Buffer(5, 0), LongMath::Sign::NEG);
+
+    EXPECT_TRUE(z1.getValue().empty());
+    EXPECT_TRUE(z2.getValue().empty());
+    EXPECT_FALSE(z2.isNegative());
+    EXPECT_FALSE(z3.isNegative());
+    EXPECT_EQ(z1, z3);
+
+    LongMath l("-000123");
+    EXPECT_EQ(3u, l.getValue().size());
+    EXPECT_EQ(LongMath(-123), l);
+
+    LongMath z4(0);
+    z4.opposite();
+    EXPECT_FALSE(z4.isNegative());
+    EXPECT_FALSE((LongMath(-5) * LongMath(0)).isNegative());
+    EXPECT_TRUE((LongMath(0) << 3).getValue().empty());
+}
+
+TEST(LongMath, Hash)
+{
+    std::hash<LongMath> h;
+
+    EXPECT_EQ(h(LongMath("12345678901234567890")), h(LongMath("00012345678901234567890")));
+    EXPECT_EQ(h(LongMath(0)), h(LongMath("-0")));
+    EXPECT_NE(h(LongMath(12)), h(LongMath(-12)));
+    EXPECT_NE(h(LongMath(12)), h(LongMath(21)));
+
+    // cached hashes must follow the value
+    LongMath l(12);
+    const size_t before = h(l);
+    EXPECT_NE(before, h(l << 1));
+    EXPECT_NE(before, h(l * 3));
+
+    const std::string text = "987";
+    from_chars(text.data(), text.data() + text.size(), l);
+    EXPECT_EQ(h(LongMath(987)), h(l));
+
+    std::unordered_map<LongMath, int> cache;
+    cache[LongMath("123456789012345678901234567890")] = 1;
+    cache[LongMath(-7)] = 2;
+
+    EXPECT_EQ(1, cache[LongMath("123456789012345678901234567890")]);
+    EXPECT_EQ(2, cache[LongMath(-7)]);
+    EXPECT_EQ(2u, cache.size());
+}
+
+TEST(LongMath, KaratsubaUnbalanced)
+{
+    LongMath l("123456789012345678901234567890"), r("98765");
+    LongMath expected = l;
+    expected.standardMultiplication(r);
+
+    LongMath k1(l), k2(r);
+    k1.karatsubaMultiplication(r);
+    k2.karatsubaMultiplication(l);
+
+    EXPECT_EQ(expected, k1);
+    EXPECT_EQ(expected, k2);
+}
+
+TEST(LongMath, TransformedConstant)
+{
+    const LongMath constant("-31415926535897932384626433832795028841971693993751058209749445923");
+    const LongMath::Transformed digits = constant.transformed(100);
+    EXPECT_EQ(LongMath::Sign::NEG, digits.getSign());
+
+    for (auto const & value : { "27182818284590452353602874713526624977572470936999595749669676277240766303535",
+                                "-12345678901234567890", "7", "0" })
+    {
+        LongMath expected(value), product(value);
+        expected.standardMultiplication(constant);
+        product.strassenMultiplication(digits);
+
+        EXPECT_EQ(expected, product);
+    }
+
+    // factors longer than the transform are split
+    std::string long_value(1000, '9');
+    LongMath expected(long_value), product(long_value);
+    expected.strassenMultiplication(constant);
+    product.strassenMultiplication(digits);
+    EXPECT_EQ(expected, product);
+
+    // the sign travels with the handle, copies included
+    const LongMath::Transformed positive = LongMath("271828").transformed(10);
+    const LongMath::Transformed copy = positive;
+    LongMath negative_product("-1000");
+    negative_product.strassenMultiplication(copy);
+    EXPECT_EQ(LongMath("-271828000"), negative_product);
+}
+
 TEST(LongMath, 12DigitsProduct)
 {
-    /*LongMath left_factor("123456789012");
+    LongMath left_factor("123456789012");
     LongMath right_factor("987654321098");
     LongMath result("121932631136585886175176");
     
     test_mult(left_factor, right_factor, result, "12DigitsProduct");
-*/
 }
 
 TEST(LongMath, ManyProducts)